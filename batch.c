@@ -0,0 +1,259 @@
+#include "batch.h"
+#include "bitboard.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define BATCH_CHUNK 4 // puzzles taken per queue operation
+
+// Subtrees for a parallel single-puzzle search
+#define BATCH_MAX_TASKS 512
+#define BATCH_TASKS_PER_THREAD 16
+
+// Remaining work of one thread as [begin, end) packed into one word, so
+// the owner taking from the front and thieves splitting off the back
+// both update it with a single compare-and-swap.
+typedef struct {
+    _Atomic unsigned long long range;
+    char pad[64 - sizeof(unsigned long long)];
+} WorkQueue;
+
+struct BatchPool {
+    int threads;
+    pthread_t *workers;
+    WorkQueue *queues;
+
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    unsigned generation; // bumped for every batch
+    int busy;            // pool threads still working on the current batch
+    bool shutdown;
+
+    // Current batch: job() runs items [begin, end)
+    void (*job)(BatchPool *pool, unsigned begin, unsigned end);
+    int limit;
+    const u8 (*puzzles)[CELLS];
+    int *counts;
+    u8 (*solutions)[CELLS];
+    Technique ceiling;
+    Rating *ratings;
+    BandBoard *tasks;     // subtrees of the puzzle in batch_count_parallel()
+    atomic_int shared;    // solutions found by all threads on that puzzle
+};
+
+typedef struct {
+    BatchPool *pool;
+    int id;
+} WorkerArg;
+
+static inline unsigned long long pack_range(unsigned begin, unsigned end) {
+    return ((unsigned long long)begin << 32) | end;
+}
+
+// Take up to BATCH_CHUNK items from the front of our own queue
+static bool take(WorkQueue *q, unsigned *begin, unsigned *end) {
+    unsigned long long r = atomic_load(&q->range);
+    for (;;) {
+        unsigned b = (unsigned)(r >> 32), e = (unsigned)r;
+        if (b >= e) return false;
+        unsigned nb = (e - b > BATCH_CHUNK) ? b + BATCH_CHUNK : e;
+        if (atomic_compare_exchange_weak(&q->range, &r, pack_range(nb, e))) {
+            *begin = b;
+            *end = nb;
+            return true;
+        }
+    }
+}
+
+// Move the back half of a victim's remaining range into our empty queue
+static bool steal(WorkQueue *victim, WorkQueue *self) {
+    unsigned long long r = atomic_load(&victim->range);
+    for (;;) {
+        unsigned b = (unsigned)(r >> 32), e = (unsigned)r;
+        if (b >= e) return false;
+        unsigned mid = b + (e - b) / 2;
+        if (atomic_compare_exchange_weak(&victim->range, &r, pack_range(b, mid))) {
+            atomic_store(&self->range, pack_range(mid, e));
+            return true;
+        }
+    }
+}
+
+static void run_queue(BatchPool *pool, int id) {
+    WorkQueue *self = &pool->queues[id];
+    for (;;) {
+        unsigned begin, end;
+        if (take(self, &begin, &end)) {
+            pool->job(pool, begin, end);
+            continue;
+        }
+
+        bool stolen = false;
+        for (int k = 1; k < pool->threads && !stolen; k++)
+            stolen = steal(&pool->queues[(id + k) % pool->threads], self);
+        if (!stolen) return;
+    }
+}
+
+static void *worker_main(void *p) {
+    WorkerArg *arg = p;
+    BatchPool *pool = arg->pool;
+    int id = arg->id;
+    free(arg);
+
+    unsigned seen = 0;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen) pthread_cond_wait(&pool->start, &pool->lock);
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_queue(pool, id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->done);
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+BatchPool *batch_pool_create(int threads) {
+    if (threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (n > 0) ? (int)n : 1;
+    }
+
+    BatchPool *pool = calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+    pool->queues = aligned_alloc(64, sizeof(WorkQueue) * (size_t)threads);
+    pool->workers = calloc((size_t)threads, sizeof(pthread_t));
+    pool->tasks = malloc(sizeof(BandBoard) * BATCH_MAX_TASKS);
+    if (!pool->queues || !pool->workers || !pool->tasks) {
+        free(pool->queues);
+        free(pool->workers);
+        free(pool->tasks);
+        free(pool);
+        return NULL;
+    }
+    for (int i = 0; i < threads; i++) atomic_init(&pool->queues[i].range, 0);
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    // Thread 0 is the caller; if a worker cannot be started, run with fewer
+    pool->threads = 1;
+    for (int i = 1; i < threads; i++) {
+        WorkerArg *arg = malloc(sizeof(*arg));
+        if (!arg) break;
+        arg->pool = pool;
+        arg->id = i;
+        if (pthread_create(&pool->workers[i], NULL, worker_main, arg) != 0) {
+            free(arg);
+            break;
+        }
+        pool->threads++;
+    }
+    return pool;
+}
+
+void batch_pool_destroy(BatchPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->threads; i++) pthread_join(pool->workers[i], NULL);
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool->tasks);
+    free(pool);
+}
+
+int batch_pool_threads(const BatchPool *pool) {
+    return pool->threads;
+}
+
+// Spread items [0, n) of the current job over all threads and wait for them
+static void run_batch(BatchPool *pool, int n) {
+    // Even split up front; stealing evens out items of unequal difficulty
+    for (int t = 0; t < pool->threads; t++) {
+        unsigned begin = (unsigned)((long long)n * t / pool->threads);
+        unsigned end = (unsigned)((long long)n * (t + 1) / pool->threads);
+        atomic_store(&pool->queues[t].range, pack_range(begin, end));
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->busy = pool->threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    run_queue(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void count_job(BatchPool *pool, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++)
+        pool->counts[i] = bitboard_count_solutions(pool->puzzles[i], pool->limit,
+                                                   pool->solutions ? pool->solutions[i] : NULL);
+}
+
+void batch_count(BatchPool *pool, const u8 (*puzzles)[CELLS], int n, int limit,
+                 int *counts, u8 (*solutions)[CELLS]) {
+    if (n <= 0) return;
+    pool->job = count_job;
+    pool->puzzles = puzzles;
+    pool->limit = limit;
+    pool->counts = counts;
+    pool->solutions = solutions;
+    run_batch(pool, n);
+}
+
+static void rate_job(BatchPool *pool, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++) rate_puzzle(pool->puzzles[i], pool->ceiling, &pool->ratings[i]);
+}
+
+void batch_rate(BatchPool *pool, const u8 (*puzzles)[CELLS], int n, Technique ceiling, Rating *ratings) {
+    if (n <= 0) return;
+    pool->job = rate_job;
+    pool->puzzles = puzzles;
+    pool->ceiling = ceiling;
+    pool->ratings = ratings;
+    run_batch(pool, n);
+}
+
+static void subtree_job(BatchPool *pool, unsigned begin, unsigned end) {
+    for (unsigned i = begin; i < end; i++)
+        bitboard_count_shared(&pool->tasks[i], pool->limit, &pool->shared);
+}
+
+int batch_count_parallel(BatchPool *pool, const u8 grid[CELLS], int limit) {
+    int found = 0;
+    int want = pool->threads * BATCH_TASKS_PER_THREAD;
+    if (want > BATCH_MAX_TASKS / 2) want = BATCH_MAX_TASKS / 2;
+
+    int n = bitboard_split(grid, pool->tasks, BATCH_MAX_TASKS, want, &found);
+    atomic_store(&pool->shared, found);
+    if (n > 0 && found < limit) {
+        pool->job = subtree_job;
+        pool->limit = limit;
+        run_batch(pool, n);
+    }
+
+    // Threads finishing together can overshoot the limit
+    int total = atomic_load(&pool->shared);
+    return total < limit ? total : limit;
+}
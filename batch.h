@@ -0,0 +1,30 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "rate.h"
+#include "sudoku.h"
+
+// Fixed pool of worker threads for solving many puzzles at once. The
+// caller's thread works alongside the pool while a batch is running.
+typedef struct BatchPool BatchPool;
+
+// threads <= 0 uses one thread per online CPU. Returns NULL on failure.
+BatchPool *batch_pool_create(int threads);
+void batch_pool_destroy(BatchPool *pool);
+int batch_pool_threads(const BatchPool *pool);
+
+// Count the solutions of puzzles[0..n) up to limit each, writing counts[i].
+// If solutions is not NULL, solutions[i] receives the first solution found.
+// Work is split into per-thread ranges that idle threads steal from.
+void batch_count(BatchPool *pool, const u8 (*puzzles)[CELLS], int n, int limit,
+                 int *counts, u8 (*solutions)[CELLS]);
+
+// Rate puzzles[0..n) with rate_puzzle() up to ceiling, writing ratings[i]
+void batch_rate(BatchPool *pool, const u8 (*puzzles)[CELLS], int n, Technique ceiling, Rating *ratings);
+
+// Count the solutions of one puzzle up to limit using every pool thread.
+// The search tree is split into subtrees at a shallow depth; threads take
+// and steal subtrees and all stop once limit solutions are found.
+int batch_count_parallel(BatchPool *pool, const u8 grid[CELLS], int limit);
+
+#endif // BATCH_H
@@ -0,0 +1,1181 @@
+// Native solver/generator benchmark.
+// Build: cc -O2 -pthread -o bench bench.c sudoku.c candidates.c dlx.c bitboard.c batch.c pool.c canon.c corpus.c rate.c
+// Usage: ./bench [puzzles]
+//        ./bench --json [samples]   regression suite only, as JSON on stdout
+//        ./bench --micro [reps]     kernel microbenchmarks with hardware counters
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // syscall()
+#include "sudoku.h"
+#include "dlx.h"
+#include "candidates.h"
+#include "bitboard.h"
+#include "batch.h"
+#include "pool.h"
+#include "canon.h"
+#include "corpus.h"
+#include "rate.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+// Reference solver: the original is_valid() scanning backtracker
+static int count_solutions_scan(u8 grid[CELLS]) {
+    int row, col;
+    int total = 0;
+
+    if (!find_empty(grid, &row, &col)) return 1;
+
+    for (int val = 1; val <= 9; val++) {
+        if (is_valid(grid, row, col, val)) {
+            grid[idx(row, col)] = val;
+            total += count_solutions_scan(grid);
+            grid[idx(row, col)] = 0;
+            if (total > 1) return total;
+        }
+    }
+    return total;
+}
+
+// Candidate masks of all 81 cells through is_valid(), the pre-bitmask way
+static void candidates_scan(const u8 grid[CELLS], u16 out[CAND_PAD]) {
+    for (int r = 0; r < 9; r++)
+        for (int c = 0; c < 9; c++) {
+            u16 cands = 0;
+            if (grid[idx(r, c)] == 0)
+                for (int v = 1; v <= 9; v++)
+                    if (is_valid(grid, r, c, (u8)v)) cands |= digit_bit(v);
+            out[idx(r, c)] = cands;
+        }
+}
+
+static void bench_kernels(u8 (*puzzles)[CELLS], int n) {
+    const int reps = 2000;
+    u16 cands[CAND_PAD];
+    u64 singles[2];
+    volatile int sink = 0;
+
+    double t0 = now_sec();
+    for (int k = 0; k < reps; k++)
+        for (int i = 0; i < n; i++) {
+            candidates_scan(puzzles[i], cands);
+            sink += cands[k % CELLS];
+        }
+    double scan = (now_sec() - t0) * 1e9 / ((double)reps * n);
+    printf("%-40s %10.1f ns/grid\n", "candidates (is_valid scan)", scan);
+
+    static const CandidateKernel kernels[] = {CAND_KERNEL_SCALAR, CAND_KERNEL_SSE41, CAND_KERNEL_AVX2, CAND_KERNEL_SIMD128};
+    for (int k = 0; k < 4; k++) {
+        char label[48];
+        if (!candidates_use(kernels[k])) continue;
+        t0 = now_sec();
+        for (int j = 0; j < reps; j++)
+            for (int i = 0; i < n; i++) {
+                CandidateMasks m;
+                masks_init(&m, puzzles[i]);
+                candidates_all(puzzles[i], &m, cands);
+                sink += candidates_naked_singles(cands, singles);
+            }
+        double dt = (now_sec() - t0) * 1e9 / ((double)reps * n);
+        snprintf(label, sizeof(label), "candidates+singles (%s)", candidates_kernel_name(kernels[k]));
+        printf("%-40s %10.1f ns/grid  %6.1fx vs scan\n", label, dt, scan / dt);
+    }
+    candidates_use(CAND_KERNEL_AUTO);
+}
+
+// Batch throughput on a larger corpus built by cycling the puzzle set
+static void bench_batch(u8 (*puzzles)[CELLS], int n) {
+    const int total = 20000;
+    u8 (*corpus)[CELLS] = malloc((size_t)total * CELLS);
+    int *counts = malloc(sizeof(int) * total);
+    if (!corpus || !counts) {
+        free(corpus);
+        free(counts);
+        return;
+    }
+    for (int i = 0; i < total; i++) memcpy(corpus[i], puzzles[i % n], CELLS);
+
+    // 1, 2, 4, 8 and then every online CPU if that is not already covered
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int threads[5] = {1, 2, 4, 8};
+    int nthreads = 4;
+    if (cpus != 1 && cpus != 2 && cpus != 4 && cpus != 8 && cpus > 0) threads[nthreads++] = (int)cpus;
+
+    double base = 0;
+    for (int k = 0; k < nthreads; k++) {
+        BatchPool *pool = batch_pool_create(threads[k]);
+        if (!pool) break;
+        batch_count(pool, (const u8 (*)[CELLS])corpus, total, 2, counts, NULL); // warm up
+        double t0 = now_sec();
+        batch_count(pool, (const u8 (*)[CELLS])corpus, total, 2, counts, NULL);
+        double rate = total / (now_sec() - t0);
+        if (k == 0) base = rate;
+
+        char label[48];
+        snprintf(label, sizeof(label), "batch_count (%d threads)", batch_pool_threads(pool));
+        printf("%-40s %8d puzzles  %10.1f puzzles/sec  %5.2fx\n", label, total, rate, rate / base);
+        batch_pool_destroy(pool);
+    }
+    free(corpus);
+    free(counts);
+}
+
+// Hole digging with a full count_solutions() per clue vs the exclusion test
+static void bench_dig(int n) {
+    static const struct { const char *name; int holes; } levels[] = {
+        {"EASY", EASY_HOLES},
+        {"MEDIUM", MEDIUM_HOLES},
+        {"HARD", HARD_HOLES},
+    };
+    Board b;
+    board_init(&b);
+
+    for (int l = 0; l < 3; l++) {
+        double ms[2];
+        for (int k = 0; k < 2; k++) {
+            b.config.dig_by_exclusion = k == 1;
+            board_seed(&b, 777);
+            double t0 = now_sec();
+            for (int i = 0; i < n; i++) make_puzzle(&b, levels[l].holes);
+            ms[k] = (now_sec() - t0) * 1e3 / n;
+        }
+        char label[48];
+        snprintf(label, sizeof(label), "dig %s (count vs exclusion)", levels[l].name);
+        printf("%-40s %8.3f -> %.3f ms/puzzle  %5.2fx\n", label, ms[0], ms[1], ms[0] / ms[1]);
+    }
+}
+
+// rand() % n vs the bounded Rng draw on the hole-digging shuffle, and the
+// checksum of fixed (seed, difficulty) puzzles to compare across builds
+static void bench_rng(void) {
+    enum { SHUFFLES = 200000 };
+    int indices[CELLS];
+    for (int i = 0; i < CELLS; i++) indices[i] = i;
+    u8 order[CELLS];
+    u64 sink = 0;
+
+    srand(1);
+    double t0 = now_sec();
+    for (int k = 0; k < SHUFFLES; k++) {
+        for (int i = CELLS - 1; i > 0; i--) {
+            int j = rand() % (i + 1);
+            int tmp = indices[i];
+            indices[i] = indices[j];
+            indices[j] = tmp;
+        }
+        sink += (u64)indices[0];
+    }
+    double t_rand = (now_sec() - t0) * 1e9 / SHUFFLES;
+
+    Rng rng;
+    rng_seed(&rng, 1);
+    for (int i = 0; i < CELLS; i++) order[i] = (u8)i;
+    t0 = now_sec();
+    for (int k = 0; k < SHUFFLES; k++) {
+        shuffle_u8(&rng, order, CELLS);
+        sink += order[0];
+    }
+    double t_rng = (now_sec() - t0) * 1e9 / SHUFFLES;
+    printf("%-40s %8.1f -> %.1f ns/shuffle  %5.2fx  (%llu)\n", "81-cell shuffle (rand vs rng)", t_rand, t_rng,
+           t_rand / t_rng, sink % 10);
+
+    static const int holes[3] = {EASY_HOLES, MEDIUM_HOLES, HARD_HOLES};
+    Board b;
+    board_init(&b);
+    u64 sum = 0;
+    for (int seed = 1; seed <= 8; seed++)
+        for (int l = 0; l < 3; l++) {
+            make_puzzle_seeded(&b, (u64)seed, holes[l]);
+            for (int i = 0; i < CELLS; i++) sum = sum * 31 + b.values[i];
+        }
+    printf("%-40s %016llx\n", "seeded puzzles 1..8 checksum", sum);
+}
+
+// Full-grid generation: backtracking from empty, after a diagonal-box
+// prefill, or by transforming a base grid. Distribution columns: chi-square
+// of per-cell digit counts over its degrees of freedom (near 1 when every
+// digit is equally likely in every cell) and how often r1c1 equals r5c5,
+// two cells in different units of boxes 1 and 5.
+static void bench_fill(int n) {
+    static const struct { const char *name; bool (*generate)(u8 *, Rng *); FillMethod fill; } impls[] = {
+        {"recursive", generator_recursive, FILL_SEARCH},
+        {"diagonal", generator_recursive, FILL_DIAGONAL},
+        {"transform", generator_transform, FILL_TRANSFORM},
+    };
+    enum { GRIDS = 4000 };
+    const int nimpls = (int)(sizeof(impls) / sizeof(impls[0]));
+    static long counts[CELLS][9];
+    double *times = malloc(GRIDS * sizeof(double));
+    u8 work[CELLS];
+    Rng rng;
+    FillMethod saved = searchDefaults.fill;
+    if (!times) return;
+
+    for (int k = 0; k < nimpls; k++) {
+        searchDefaults.fill = impls[k].fill;
+        rng_seed(&rng, 3);
+        memset(counts, 0, sizeof(counts));
+        long same = 0;
+        double total = 0;
+        for (int i = 0; i < GRIDS; i++) {
+            double t0 = now_sec();
+            memset(work, 0, CELLS);
+            impls[k].generate(work, &rng);
+            times[i] = now_sec() - t0;
+            total += times[i];
+            for (int c = 0; c < CELLS; c++) counts[c][work[c] - 1]++;
+            same += work[idx(0, 0)] == work[idx(4, 4)];
+        }
+        double expect = GRIDS / 9.0, chi2 = 0;
+        for (int c = 0; c < CELLS; c++)
+            for (int d = 0; d < 9; d++) chi2 += (counts[c][d] - expect) * (counts[c][d] - expect) / expect;
+        qsort(times, GRIDS, sizeof(double), cmp_double);
+
+        char label[48];
+        snprintf(label, sizeof(label), "fill grid (%s)", impls[k].name);
+        printf("%-40s %10.1f grids/sec  p99 %7.1f us  chi2/df %.2f  r1c1=r5c5 %.3f\n", label, GRIDS / total,
+               times[GRIDS * 99 / 100] * 1e6, chi2 / (CELLS * 8), (double)same / GRIDS);
+    }
+    searchDefaults.fill = saved;
+    free(times);
+
+    Board b;
+    board_init(&b);
+    for (int k = 0; k < nimpls; k++) {
+        b.config.fill = impls[k].fill;
+        board_seed(&b, 3);
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) make_puzzle(&b, HARD_HOLES);
+        double dt = now_sec() - t0;
+        char label[48];
+        snprintf(label, sizeof(label), "generate HARD (%s fill)", impls[k].name);
+        printf("%-40s %8d puzzles  %10.1f puzzles/sec  %8.3f ms/puzzle\n", label, n, n / dt, dt * 1e3 / n);
+    }
+}
+
+static bool checksum_solution(const u8 grid[CELLS], void *user) {
+    unsigned *sum = user;
+    for (int i = 0; i < CELLS; i++) *sum = *sum * 31 + grid[i];
+    return true;
+}
+
+// Streaming enumeration of an ambiguous puzzle: a generated HARD puzzle
+// with extra clues removed, solutions fed to a callback as they are found
+static void bench_enumerate(const u8 puzzle[CELLS]) {
+    const int limit = 100000;
+    u8 work[CELLS];
+    memcpy(work, puzzle, CELLS);
+    for (int i = 0, removed = 0; i < CELLS && removed < 8; i++)
+        if (work[i] != 0) {
+            work[i] = 0;
+            removed++;
+        }
+
+    unsigned sum = 0;
+    long nodes = 0;
+    double t0 = now_sec();
+    int found = enumerate_solutions(work, limit, checksum_solution, &sum, &nodes);
+    double dt = now_sec() - t0;
+    printf("%-40s %8d solutions %10.1f solutions/sec  %ld nodes\n", "enumerate_solutions", found, found / dt, nodes);
+}
+
+// Known hard puzzles for single-puzzle latency
+static const char *hard_puzzles[] = {
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "..............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9",
+    ".......1.4.........2...........5.4.7..8...3....1.9....3..4..2...5.1........8.6...",
+};
+
+static void parse_puzzle(const char *s, u8 grid[CELLS]) {
+    for (int i = 0; i < CELLS; i++) grid[i] = (s[i] >= '1' && s[i] <= '9') ? (u8)(s[i] - '0') : 0;
+}
+
+// Latency of one uniqueness check, sequential vs split across the pool
+static void bench_parallel_one(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    BatchPool *pool = batch_pool_create(cpus > 0 ? (int)cpus : 1);
+    if (!pool) return;
+
+    for (int k = 0; k < (int)(sizeof(hard_puzzles) / sizeof(hard_puzzles[0])); k++) {
+        u8 puzzle[CELLS];
+        parse_puzzle(hard_puzzles[k], puzzle);
+
+        int reps = 0;
+        double t0 = now_sec(), seq, par;
+        do {
+            bitboard_count_solutions(puzzle, 2, NULL);
+            reps++;
+        } while ((seq = now_sec() - t0) < 0.2);
+        seq /= reps;
+
+        reps = 0;
+        t0 = now_sec();
+        do {
+            batch_count_parallel(pool, puzzle, 2);
+            reps++;
+        } while ((par = now_sec() - t0) < 0.2);
+        par /= reps;
+
+        char label[48];
+        snprintf(label, sizeof(label), "uniqueness hard #%d (%d threads)", k, batch_pool_threads(pool));
+        printf("%-40s %10.1f us seq  %10.1f us parallel  %5.2fx\n", label, seq * 1e6, par * 1e6, seq / par);
+    }
+    batch_pool_destroy(pool);
+}
+
+static DlxSolver dlx;
+
+static int count_solutions_dlx(u8 grid[CELLS]) {
+    return dlx_count_solutions(&dlx, grid, 2);
+}
+
+static int count_solutions_bitboard(u8 grid[CELLS]) {
+    return bitboard_count_solutions(grid, 2, NULL);
+}
+
+// Repeats passes over the set for at least 0.25 s so fast solvers are measurable
+static void bench_count(const char *name, int (*count)(u8 *), u8 (*puzzles)[CELLS], int n) {
+    u8 work[CELLS];
+    int unique = 0;
+    long solved = 0;
+    double t0 = now_sec(), dt;
+    do {
+        unique = 0;
+        for (int i = 0; i < n; i++) {
+            memcpy(work, puzzles[i], CELLS);
+            if (count(work) == 1) unique++;
+        }
+        solved += n;
+        dt = now_sec() - t0;
+    } while (dt < 0.25);
+    printf("%-40s %8d puzzles  %10.1f puzzles/sec  (%d unique)\n", name, n, solved / dt, unique);
+}
+
+// Peak stack use of a call: paint a region below the caller's frame, run
+// the call, then see how much of the paint was overwritten
+#define STACK_PROBE (256 * 1024)
+
+static __attribute__((noinline)) void stack_paint(void) {
+    u8 buf[STACK_PROBE];
+    memset(buf, 0xA5, sizeof(buf));
+    __asm__ volatile("" : : "r"(buf) : "memory"); // keep the stores
+}
+
+static __attribute__((noinline)) int stack_used(void) {
+    u8 buf[STACK_PROBE];
+    __asm__ volatile("" : "=m"(buf)); // contents are whatever the call left
+    int untouched = 0;
+    while (untouched < STACK_PROBE && buf[untouched] == 0xA5) untouched++;
+    return STACK_PROBE - untouched;
+}
+
+static void bench_iterative(u8 (*puzzles)[CELLS], int n) {
+    static const struct { const char *name; int (*count)(u8 *); bool (*generate)(u8 *, Rng *); } impls[] = {
+        {"recursive", count_solutions, generator_recursive},
+        {"iterative", count_solutions_iterative, generator_iterative},
+    };
+    u8 work[CELLS];
+    Rng rng;
+
+    for (int k = 0; k < 2; k++) {
+        int count_stack = 0, gen_stack = 0;
+        rng_seed(&rng, 1);
+        for (int i = 0; i < n; i++) {
+            memcpy(work, puzzles[i], CELLS);
+            stack_paint();
+            impls[k].count(work);
+            int used = stack_used();
+            if (used > count_stack) count_stack = used;
+
+            memset(work, 0, CELLS);
+            stack_paint();
+            impls[k].generate(work, &rng);
+            used = stack_used();
+            if (used > gen_stack) gen_stack = used;
+        }
+
+        char label[48];
+        snprintf(label, sizeof(label), "count_solutions (%s)", impls[k].name);
+        bench_count(label, impls[k].count, puzzles, n);
+
+        rng_seed(&rng, 1);
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) {
+            memset(work, 0, CELLS);
+            impls[k].generate(work, &rng);
+        }
+        double dt = now_sec() - t0;
+        snprintf(label, sizeof(label), "generator (%s)", impls[k].name);
+        printf("%-40s %8d grids    %10.1f grids/sec\n", label, n, n / dt);
+        printf("%-40s %8d bytes count  %8d bytes generate\n", "  peak stack", count_stack, gen_stack);
+    }
+}
+
+// 99th percentile step of a frame-sliced HARD generation against the worst
+// whole make_puzzle_seeded() call it replaces
+static void bench_sliced(int n) {
+    static const long budgets[] = {100, 500};
+    enum { MAX_STEPS = 1 << 16 };
+    PuzzleJob *job = puzzle_job_create(&searchDefaults);
+    double *times = malloc(MAX_STEPS * sizeof(double));
+    if (!job || !times) {
+        puzzle_job_destroy(job);
+        free(times);
+        return;
+    }
+    Board b;
+    board_init(&b);
+
+    double whole_max = 0;
+    for (int i = 0; i < n; i++) {
+        double t0 = now_sec();
+        make_puzzle_seeded(&b, (u64)i + 1, HARD_HOLES);
+        double dt = now_sec() - t0;
+        if (dt > whole_max) whole_max = dt;
+    }
+
+    for (int k = 0; k < 2; k++) {
+        int steps = 0;
+        for (int i = 0; i < n; i++) {
+            puzzle_job_start(job, (u64)i + 1, HARD_HOLES);
+            bool done;
+            do {
+                double t0 = now_sec();
+                done = puzzle_job_step(job, budgets[k]);
+                if (steps < MAX_STEPS) times[steps++] = now_sec() - t0;
+            } while (!done);
+        }
+        qsort(times, (size_t)steps, sizeof(double), cmp_double);
+        char label[48];
+        snprintf(label, sizeof(label), "sliced HARD (%ld us budget, p99)", budgets[k]);
+        printf("%-40s %8.3f -> %.3f ms/frame  %5.1f frames/puzzle\n", label, whole_max * 1e3,
+               times[steps * 99 / 100] * 1e3, (double)steps / n);
+    }
+    puzzle_job_destroy(job);
+    free(times);
+}
+
+// Time to start a game: make_puzzle() in the frame vs taking from a warm
+// pool while the worker refills it between takes, one take per 16 ms frame
+static void bench_pool(void) {
+    static const char *names[POOL_LEVELS] = {"EASY", "MEDIUM", "HARD"};
+    static const int holes[POOL_LEVELS] = {EASY_HOLES, MEDIUM_HOLES, HARD_HOLES};
+    enum { DEPTH = 4, TAKES = 20 };
+    const struct timespec frame = {0, 16 * 1000 * 1000};
+
+    PuzzlePool *pool = puzzle_pool_create(DEPTH, 4242);
+    if (!pool) return;
+    for (int l = 0; l < POOL_LEVELS; l++) {
+        PoolStats st;
+        do {
+            nanosleep(&frame, NULL);
+            puzzle_pool_stats(pool, l, &st);
+        } while (st.ready < DEPTH);
+    }
+
+    Board b;
+    board_init(&b);
+    for (int l = 0; l < POOL_LEVELS; l++) {
+        double sync_max = 0, take_max = 0;
+        for (int i = 0; i < TAKES; i++) {
+            double t0 = now_sec();
+            make_puzzle(&b, holes[l]);
+            double dt = now_sec() - t0;
+            if (dt > sync_max) sync_max = dt;
+
+            t0 = now_sec();
+            puzzle_pool_take(pool, holes[l], &b);
+            dt = now_sec() - t0;
+            if (dt > take_max) take_max = dt;
+            nanosleep(&frame, NULL);
+        }
+
+        PoolStats st;
+        puzzle_pool_stats(pool, l, &st);
+        char label[48];
+        snprintf(label, sizeof(label), "start game %s (sync vs pool, max)", names[l]);
+        printf("%-40s %8.3f -> %.3f ms  hits %ld  misses %ld  refill %.3f ms avg %.3f ms max\n", label,
+               sync_max * 1e3, take_max * 1e3, st.hits, st.misses, st.refill_ms, st.refill_max_ms);
+    }
+    puzzle_pool_destroy(pool);
+}
+
+// Minlex canonicalization rate per difficulty, and dedupe of a stream where
+// every puzzle appears under several random symmetries
+static void bench_canon(int n) {
+    static const struct { const char *name; int holes; } levels[] = {
+        {"EASY", EASY_HOLES},
+        {"MEDIUM", MEDIUM_HOLES},
+        {"HARD", HARD_HOLES},
+        {"full grid", 0},
+    };
+    enum { COPIES = 4 };
+    Canonizer *c = canon_create();
+    u8 (*set)[CELLS] = malloc((size_t)n * CELLS);
+    if (!c || !set) {
+        canon_destroy(c);
+        free(set);
+        return;
+    }
+    Board b;
+    board_init(&b);
+    board_seed(&b, 31337);
+    Rng rng;
+    rng_seed(&rng, 31337);
+
+    for (int l = 0; l < 4; l++) {
+        for (int i = 0; i < n; i++) {
+            make_puzzle(&b, levels[l].holes);
+            memcpy(set[i], levels[l].holes ? b.givens : b.solution, CELLS);
+        }
+        int reps = 0;
+        double t0 = now_sec(), dt;
+        do {
+            for (int i = 0; i < n; i++) {
+                u8 out[CELLS];
+                canon_minlex(c, set[i], out);
+            }
+            reps++;
+        } while ((dt = now_sec() - t0) < 0.2);
+        char label[48];
+        snprintf(label, sizeof(label), "canonicalize %s", levels[l].name);
+        printf("%-40s %8d grids  %10.1f grids/sec  %8.3f us/grid\n", label, n, reps * n / dt, dt * 1e6 / (reps * n));
+
+        if (levels[l].holes != HARD_HOLES && levels[l].holes) continue;
+        CanonSet *seen = canon_set_create();
+        if (!seen) continue;
+        int fresh = 0;
+        t0 = now_sec();
+        for (int k = 0; k < COPIES; k++)
+            for (int i = 0; i < n; i++) {
+                u8 copy[CELLS];
+                grid_transform(copy, set[i], &rng);
+                fresh += canon_set_insert(seen, copy);
+            }
+        dt = now_sec() - t0;
+        snprintf(label, sizeof(label), "dedupe %s transformed copies", levels[l].name);
+        printf("%-40s %8d inserted  %d unique (expect %d)  %10.1f inserts/sec\n", label, COPIES * n, fresh, n,
+               COPIES * n / dt);
+        canon_set_destroy(seen);
+    }
+    free(set);
+    canon_destroy(c);
+}
+
+// Human-technique rating rate per difficulty, one thread and through the
+// batch pool, and how the puzzles of each difficulty grade
+static void bench_rate(int n) {
+    static const struct { const char *name; int holes; } levels[] = {
+        {"EASY", EASY_HOLES},
+        {"MEDIUM", MEDIUM_HOLES},
+        {"HARD", HARD_HOLES},
+    };
+    u8 (*set)[CELLS] = malloc((size_t)n * CELLS);
+    Rating *ratings = malloc(sizeof(Rating) * (size_t)n);
+    BatchPool *pool = batch_pool_create(0);
+    if (!set || !ratings || !pool) {
+        free(set);
+        free(ratings);
+        batch_pool_destroy(pool);
+        return;
+    }
+    Board b;
+    board_init(&b);
+    board_seed(&b, 2718);
+
+    for (int l = 0; l < 3; l++) {
+        for (int i = 0; i < n; i++) {
+            make_puzzle(&b, levels[l].holes);
+            memcpy(set[i], b.givens, CELLS);
+        }
+        int reps = 0;
+        double t0 = now_sec(), dt;
+        do {
+            for (int i = 0; i < n; i++) rate_puzzle(set[i], TECH_TRIAL, &ratings[i]);
+            reps++;
+        } while ((dt = now_sec() - t0) < 0.2);
+        t0 = now_sec();
+        batch_rate(pool, (const u8 (*)[CELLS])set, n, TECH_TRIAL, ratings);
+        double batch_dt = now_sec() - t0;
+
+        char label[48];
+        snprintf(label, sizeof(label), "rate %s", levels[l].name);
+        printf("%-40s %8d puzzles  %10.1f ratings/sec  %8.3f us/rating  batch (%d threads) %.1f ratings/sec\n",
+               label, n, reps * n / dt, dt * 1e6 / (reps * n), batch_pool_threads(pool), n / batch_dt);
+
+        int hardest[TECH_COUNT] = {0};
+        for (int i = 0; i < n; i++) hardest[ratings[i].hardest]++;
+        printf("%-40s", "  hardest technique");
+        for (int t = 0; t < TECH_COUNT; t++)
+            if (hardest[t]) printf(" %s %d", technique_names[t], hardest[t]);
+        printf("\n");
+    }
+    batch_pool_destroy(pool);
+    free(ratings);
+    free(set);
+}
+
+// Generation to a rating band: share of attempts that land in the band and
+// attempts per delivered puzzle, with the attempt cap bounding latency
+static void bench_rated(int n) {
+    static const struct { const char *name; Technique min, max; } bands[] = {
+        {"singles", TECH_HIDDEN_SINGLE, TECH_NAKED_SINGLE},
+        {"locked candidates", TECH_LOCKED_CANDIDATES, TECH_LOCKED_CANDIDATES},
+        {"subsets and fish", TECH_PAIR, TECH_SWORDFISH},
+        {"chains", TECH_CHAIN, TECH_CHAIN},
+        {"trial", TECH_TRIAL, TECH_TRIAL},
+    };
+    enum { MAX_ATTEMPTS = 50 };
+    Board b;
+    board_init(&b);
+    board_seed(&b, 1618);
+
+    for (int k = 0; k < (int)(sizeof(bands) / sizeof(bands[0])); k++) {
+        int delivered = 0;
+        long attempts = 0, holes = 0;
+        double worst = 0, t0 = now_sec();
+        for (int i = 0; i < n; i++) {
+            Rating r;
+            int used;
+            double t1 = now_sec();
+            delivered += make_puzzle_rated(&b, bands[k].min, bands[k].max, MAX_ATTEMPTS, &r, &used);
+            double dt = now_sec() - t1;
+            if (dt > worst) worst = dt;
+            attempts += used;
+            holes += b.holes;
+        }
+        double dt = now_sec() - t0;
+        char label[48];
+        snprintf(label, sizeof(label), "generate rated %s", bands[k].name);
+        printf("%-40s %4d/%d in band  accept %5.1f%%  %5.2f attempts/puzzle  %5.1f holes  %8.3f ms avg %.3f ms max\n",
+               label, delivered, n, 100.0 * delivered / attempts, (double)attempts / n, (double)holes / n,
+               dt * 1e3 / n, worst * 1e3);
+    }
+}
+
+// Corpus footprint against 81-byte grids, and random access through the
+// mapped file. Each level is padded out with transformed copies of n
+// generated puzzles.
+static void bench_corpus(int n) {
+    static const int holes[3] = {EASY_HOLES, MEDIUM_HOLES, HARD_HOLES};
+    enum { PER_LEVEL = 100000, GETS = 1000000 };
+    CorpusBuilder *cb = corpus_builder_create();
+    u8 (*base)[CELLS] = malloc((size_t)n * CELLS);
+    if (!cb || !base) {
+        corpus_builder_destroy(cb);
+        free(base);
+        return;
+    }
+    Board b;
+    board_init(&b);
+    board_seed(&b, 8080);
+    Rng rng;
+    rng_seed(&rng, 8080);
+    u64 check = 0;
+    for (int l = 0; l < 3; l++) {
+        for (int i = 0; i < n; i++) {
+            make_puzzle(&b, holes[l]);
+            memcpy(base[i], b.givens, CELLS);
+        }
+        for (int i = 0; i < PER_LEVEL; i++) {
+            u8 grid[CELLS];
+            grid_transform(grid, base[i % n], &rng);
+            if (i < 1000) check += grid[i % CELLS];
+            corpus_builder_add(cb, holes[l], grid);
+        }
+    }
+
+    char path[] = "/tmp/sudoku-corpus-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        corpus_builder_destroy(cb);
+        free(base);
+        return;
+    }
+    close(fd);
+    double t0 = now_sec();
+    bool written = corpus_builder_write(cb, path);
+    double write_ms = (now_sec() - t0) * 1e3;
+    corpus_builder_destroy(cb);
+    free(base);
+    Corpus *c = written ? corpus_open(path) : NULL;
+    if (!c) {
+        unlink(path);
+        return;
+    }
+
+    FILE *f = fopen(path, "rb");
+    long bytes = 0;
+    if (f) {
+        fseek(f, 0, SEEK_END);
+        bytes = ftell(f);
+        fclose(f);
+    }
+    long grids = 3L * PER_LEVEL;
+    printf("%-40s %8ld puzzles  %6.1f MB vs %.1f MB as grids (%.0f%%)  write %.1f ms\n", "corpus size", grids,
+           bytes / 1e6, grids * CELLS / 1e6, 100.0 * bytes / (grids * CELLS), write_ms);
+
+    // Sequential pass: every record decodes and matches what went in
+    u64 sum = 0;
+    int bad = 0;
+    for (int l = 0; l < 3; l++)
+        for (int i = 0; i < 1000; i++) {
+            u8 grid[CELLS];
+            if (!corpus_get(c, holes[l], (u64)i, grid)) bad++;
+            sum += grid[i % CELLS];
+        }
+    for (int l = 0; l < 3; l++) {
+        u64 count = corpus_count(c, holes[l]);
+        t0 = now_sec();
+        for (int i = 0; i < GETS; i++) {
+            u8 grid[CELLS];
+            if (!corpus_get(c, holes[l], rng_next(&rng) % count, grid)) bad++;
+        }
+        double dt = now_sec() - t0;
+        char label[48];
+        snprintf(label, sizeof(label), "corpus random get (%d holes)", holes[l]);
+        printf("%-40s %8d gets  %10.1f gets/sec  %8.1f ns/get\n", label, GETS, GETS / dt, dt * 1e9 / GETS);
+    }
+    printf("%-40s %8s  %d bad records\n", "corpus round trip", sum == check ? "ok" : "MISMATCH", bad);
+    corpus_close(c);
+    unlink(path);
+}
+
+// Fixed puzzles for the regression suite, so numbers stay comparable when
+// the generator changes. easy/medium/hard came from make_puzzle_seeded();
+// pathological ones need millions of nodes from a plain first-empty
+// backtracker or hundreds with MRV and singles.
+static const struct { const char *set; const char *puzzle; } suite_corpus[] = {
+    {"easy", "2.9.31475143..58968.7964..23.814..59.1.3967844.6..8.2393..275..68451...7.2568394."},
+    {"easy", "38.62..51.45.8.6.22614357984..2179..89.543.7.7138..524639172.455.83.4..91.4.5.3.7"},
+    {"easy", "..1362497.3.5.1.26..798.153..28139..3.96.52..64872953.4.3.57.8.17629.345895436.1."},
+    {"easy", "1753..89.9..8.7.3.48.61.275..1.7495334958671.25.931.4.5124983.76347..189..816.5.."},
+    {"medium", ".37.24.8981.3.96...2.685.1.7...6..3.4..5.376.26..4...157...1....9.8..2...4829.175"},
+    {"medium", "473289.1.85...6..22..7..8....79..328.8.17.64.534...1....86..2.9.2..9.763.9..27.8."},
+    {"medium", "35.9....1.49.8..2..783.694..371.2..8.15.73.69....6...78..25.3.6.6.7....2.2163.5.4"},
+    {"medium", "4.56..2.3..13.578.763.89.5.9.276.....4.95.62..7..1294....4..8..6195.83...2.1.7..."},
+    {"hard", ".73.8....41.....6..6.........6...9..54...3.......47...9..4.8.7..2..5...3...7....8"},
+    {"hard", ".96.7.8..7..2..5.3..4.3....6.......7...4....2......41..8.56.3..4..........1..8..."},
+    {"hard", "....354.8..542.3.........7.83......1.2...9...76.8........2786...7...48.2........."},
+    {"hard", "3.....5.....57..6.6...9.1.34.1.......5...7.....38156.......1.3.5...2..8..4.7....."},
+    {"17-clue", ".......1.4.........2...........5.6.4..8...3....1.9....3..4..2...5.1........8.7..."},
+    {"17-clue", ".......12....35......6...7.7.....3.....4..8..1...........12.....8.....4..5....6.."},
+    {"17-clue", ".......12..36..........7...41..2.......5..3..7.....6..28.....4....3..5..........."},
+    {"17-clue", ".......12..8.3...........4.12.5..........47...6.......5.7...3.....62.......1....."},
+    {"pathological", "..............3.85..1.2.......5.7.....4...1...9.......5......73..2.1........4...9"},
+    {"pathological", "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4.."},
+    {"pathological", "4.....8.5.3..........7......2.....6.....8.4......1.......6.3.7.5..2.....1.4......"},
+    {"pathological", "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3.."},
+};
+
+typedef struct {
+    double mean, median, p99, max;
+} SampleStats;
+
+// Sorts t
+static SampleStats sample_stats(double *t, int n) {
+    SampleStats st = {0};
+    qsort(t, (size_t)n, sizeof(double), cmp_double);
+    for (int i = 0; i < n; i++) st.mean += t[i];
+    st.mean /= n;
+    st.median = t[n / 2];
+    st.p99 = t[(n * 99) / 100];
+    st.max = t[n - 1];
+    return st;
+}
+
+static void suite_report(bool json, bool *first, const char *name, const char *set, double *t, int n) {
+    SampleStats st = sample_stats(t, n);
+    if (json) {
+        printf("%s\n    {\"name\": \"%s\", \"set\": \"%s\", \"samples\": %d, \"mean_us\": %.3f, \"median_us\": %.3f, "
+               "\"p99_us\": %.3f, \"max_us\": %.3f}",
+               *first ? "" : ",", name, set, n, st.mean * 1e6, st.median * 1e6, st.p99 * 1e6, st.max * 1e6);
+    } else {
+        char label[48];
+        snprintf(label, sizeof(label), "%s %s", name, set);
+        printf("%-40s mean %9.1f  median %9.1f  p99 %9.1f  max %9.1f us\n", label, st.mean * 1e6, st.median * 1e6,
+               st.p99 * 1e6, st.max * 1e6);
+    }
+    *first = false;
+}
+
+// Regression suite: per-call times of count_solutions() over each corpus
+// set, of generator_recursive(), and of make_unique_puzzle_fast() per
+// difficulty. Seeds are fixed, so runs differ only in timing.
+static void bench_suite(int samples, bool json) {
+    static const char *sets[] = {"easy", "medium", "hard", "17-clue", "pathological"};
+    static const struct { const char *name; int holes; } levels[] = {
+        {"EASY", EASY_HOLES},
+        {"MEDIUM", MEDIUM_HOLES},
+        {"HARD", HARD_HOLES},
+    };
+    const int ncorpus = (int)(sizeof(suite_corpus) / sizeof(suite_corpus[0]));
+    double *t = malloc((size_t)(samples * ncorpus) * sizeof(double));
+    if (!t) return;
+    bool first = true;
+    if (json) printf("{\n  \"schema\": 1,\n  \"samples\": %d,\n  \"results\": [", samples);
+
+    for (int k = 0; k < 5; k++) {
+        int n = 0;
+        for (int i = 0; i < ncorpus; i++) {
+            if (strcmp(suite_corpus[i].set, sets[k]) != 0) continue;
+            u8 grid[CELLS];
+            parse_puzzle(suite_corpus[i].puzzle, grid);
+            for (int r = 0; r < samples; r++) {
+                double t0 = now_sec();
+                count_solutions(grid);
+                t[n++] = now_sec() - t0;
+            }
+        }
+        suite_report(json, &first, "count_solutions", sets[k], t, n);
+    }
+
+    Rng rng;
+    rng_seed(&rng, 1);
+    for (int i = 0; i < samples; i++) {
+        u8 grid[CELLS] = {0};
+        double t0 = now_sec();
+        generator_recursive(grid, &rng);
+        t[i] = now_sec() - t0;
+    }
+    suite_report(json, &first, "generator_recursive", "full", t, samples);
+
+    Board b;
+    board_init(&b);
+    for (int l = 0; l < 3; l++) {
+        for (int i = 0; i < samples; i++) {
+            b.seed = (u64)i + 1;
+            double t0 = now_sec();
+            make_unique_puzzle_fast(&b, levels[l].holes);
+            t[i] = now_sec() - t0;
+        }
+        suite_report(json, &first, "make_unique_puzzle_fast", levels[l].name, t, samples);
+    }
+    if (json) printf("\n  ]\n}\n");
+    free(t);
+}
+
+// Search statistics per corpus set and per generated HARD puzzle; needs a
+// build with -DSEARCH_STATS=1
+static void bench_stats(int n) {
+#if !SEARCH_STATS
+    (void)n;
+    printf("%-40s build with -DSEARCH_STATS=1\n", "search stats");
+#else
+    static const char *sets[] = {"easy", "medium", "hard", "17-clue", "pathological"};
+    const int ncorpus = (int)(sizeof(suite_corpus) / sizeof(suite_corpus[0]));
+    for (int k = 0; k < 5; k++) {
+        SearchStats st;
+        memset(&st, 0, sizeof(st));
+        int puzzles = 0;
+        for (int i = 0; i < ncorpus; i++) {
+            if (strcmp(suite_corpus[i].set, sets[k]) != 0) continue;
+            u8 grid[CELLS];
+            parse_puzzle(suite_corpus[i].puzzle, grid);
+            count_solutions_stats(grid, &st);
+            puzzles++;
+        }
+        long branched = 0, children = 0;
+        for (int d = 0; d < CELLS; d++) {
+            branched += st.depth_nodes[d];
+            children += st.depth_children[d];
+        }
+        char label[48];
+        snprintf(label, sizeof(label), "search stats %s", sets[k]);
+        printf("%-40s %8.1f nodes  %8.1f backtracks  max depth %2d  branching %.2f\n", label, (double)st.nodes / puzzles,
+               (double)st.backtracks / puzzles, st.max_depth, branched ? (double)children / branched : 0.0);
+    }
+
+    Board b;
+    board_init(&b);
+    board_seed(&b, 999);
+    long nodes = 0, checks = 0, worst = 0;
+    for (int i = 0; i < n; i++) {
+        make_puzzle(&b, HARD_HOLES);
+        nodes += b.stats.nodes;
+        checks += b.stats.uniqueness_checks;
+        if (b.stats.nodes > worst) worst = b.stats.nodes;
+    }
+    printf("%-40s %8.1f nodes  %8.1f uniqueness checks  worst %ld nodes\n", "search stats generate HARD",
+           (double)nodes / n, (double)checks / n, worst);
+#endif
+}
+
+//
+// Hardware counters for --micro: user-space cycles, instructions, branch
+// misses and L1d read misses of this thread through perf_event_open. Each
+// counter that fails to open (no PMU in a VM, perf_event_paranoid) reads
+// as unavailable; with none at all only clock_gettime() time is reported.
+//
+
+enum { CNT_CYCLES, CNT_INSTRUCTIONS, CNT_BRANCH_MISSES, CNT_L1D_MISSES, CNT_KINDS };
+
+typedef struct {
+    int fd[CNT_KINDS]; // -1 if unavailable
+    u64 value[CNT_KINDS];
+    double sec;
+    double t0;
+} Counters;
+
+static void counters_open(Counters *c) {
+    memset(c, 0, sizeof(*c));
+    for (int k = 0; k < CNT_KINDS; k++) c->fd[k] = -1;
+#ifdef __linux__
+    static const struct { u32 type; u64 config; } kinds[CNT_KINDS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                                 PERF_COUNT_HW_CACHE_RESULT_MISS << 16},
+    };
+    for (int k = 0; k < CNT_KINDS; k++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = kinds[k].type;
+        attr.config = kinds[k].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        c->fd[k] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+}
+
+static void counters_close(Counters *c) {
+    for (int k = 0; k < CNT_KINDS; k++)
+        if (c->fd[k] >= 0) close(c->fd[k]);
+}
+
+static bool counters_any(const Counters *c) {
+    for (int k = 0; k < CNT_KINDS; k++)
+        if (c->fd[k] >= 0) return true;
+    return false;
+}
+
+static void counters_start(Counters *c) {
+#ifdef __linux__
+    for (int k = 0; k < CNT_KINDS; k++)
+        if (c->fd[k] >= 0) {
+            ioctl(c->fd[k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    c->t0 = now_sec();
+}
+
+static void counters_stop(Counters *c) {
+    c->sec = now_sec() - c->t0;
+#ifdef __linux__
+    for (int k = 0; k < CNT_KINDS; k++) {
+        c->value[k] = 0;
+        if (c->fd[k] < 0) continue;
+        ioctl(c->fd[k], PERF_EVENT_IOC_DISABLE, 0);
+        if (read(c->fd[k], &c->value[k], sizeof(u64)) != sizeof(u64)) c->value[k] = 0;
+    }
+#endif
+}
+
+// One table row: time and each available counter divided by per
+static void counters_print(const Counters *c, const char *name, double per, const char *unit) {
+    char label[48];
+    snprintf(label, sizeof(label), "%s (per %s)", name, unit);
+    printf("%-40s %9.1f ns", label, c->sec * 1e9 / per);
+    static const char *names[CNT_KINDS] = {"cycles", "instr", "br-miss", "L1d-miss"};
+    for (int k = 0; k < CNT_KINDS && counters_any(c); k++) {
+        if (c->fd[k] < 0) printf("  %8s %s", "n/a", names[k]);
+        else printf("  %8.2f %s", c->value[k] / per, names[k]);
+    }
+    if (c->fd[CNT_CYCLES] >= 0 && c->fd[CNT_INSTRUCTIONS] >= 0 && c->value[CNT_CYCLES])
+        printf("  IPC %.2f", (double)c->value[CNT_INSTRUCTIONS] / c->value[CNT_CYCLES]);
+    printf("\n");
+}
+
+// is_valid() and find_empty() over the suite corpus, and count_solutions()
+// per call and per search node, each in a loop of its own
+static void bench_micro(int reps) {
+    const int ncorpus = (int)(sizeof(suite_corpus) / sizeof(suite_corpus[0]));
+    u8 (*grids)[CELLS] = malloc((size_t)ncorpus * CELLS);
+    if (!grids) return;
+    for (int i = 0; i < ncorpus; i++) parse_puzzle(suite_corpus[i].puzzle, grids[i]);
+
+    Counters c;
+    counters_open(&c);
+    printf("hardware counters: %s\n", counters_any(&c) ? "perf_event" : "unavailable, clock_gettime only");
+
+    // is_valid(): every digit in every empty cell
+    volatile int sink = 0;
+    long calls = 0;
+    counters_start(&c);
+    for (int r = 0; r < reps; r++)
+        for (int i = 0; i < ncorpus; i++)
+            for (int cell = 0; cell < CELLS; cell++) {
+                if (grids[i][cell]) continue;
+                for (u8 v = 1; v <= 9; v++) sink += is_valid(grids[i], cell / 9, cell % 9, v);
+                calls += 9;
+            }
+    counters_stop(&c);
+    counters_print(&c, "is_valid", (double)calls, "call");
+
+    // find_empty(): from each prefix of a solved grid with the rest empty,
+    // so the scan length varies
+    u8 (*prefixes)[CELLS] = malloc((size_t)CELLS * CELLS);
+    if (prefixes) {
+        u8 full[CELLS] = {0};
+        Rng rng;
+        rng_seed(&rng, 22);
+        generator_recursive(full, &rng);
+        for (int p = 0; p < CELLS; p++) {
+            memset(prefixes[p], 0, CELLS);
+            memcpy(prefixes[p], full, (size_t)p);
+        }
+        calls = 0;
+        counters_start(&c);
+        for (int r = 0; r < reps * 10; r++)
+            for (int p = 0; p < CELLS; p++) {
+                int row, col;
+                sink += find_empty(prefixes[p], &row, &col);
+                calls++;
+            }
+        counters_stop(&c);
+        counters_print(&c, "find_empty", (double)calls, "call");
+        free(prefixes);
+    }
+
+    // count_solutions(): search nodes from enumerate_solutions() with the
+    // same limit of 2
+    static const char *sets[] = {"easy", "hard", "17-clue", "pathological"};
+    for (int k = 0; k < 4; k++) {
+        long nodes = 0;
+        calls = 0;
+        for (int i = 0; i < ncorpus; i++) {
+            if (strcmp(suite_corpus[i].set, sets[k]) != 0) continue;
+            long n;
+            enumerate_solutions(grids[i], 2, NULL, NULL, &n);
+            nodes += n * reps;
+        }
+        counters_start(&c);
+        for (int r = 0; r < reps; r++)
+            for (int i = 0; i < ncorpus; i++)
+                if (strcmp(suite_corpus[i].set, sets[k]) == 0) {
+                    sink += count_solutions(grids[i]);
+                    calls++;
+                }
+        counters_stop(&c);
+        char name[48];
+        snprintf(name, sizeof(name), "count_solutions %s", sets[k]);
+        counters_print(&c, name, (double)calls, "call");
+        counters_print(&c, name, (double)nodes, "node");
+    }
+    (void)sink;
+    counters_close(&c);
+    free(grids);
+}
+
+int main(int argc, char **argv) {
+    const char *mode = (argc > 1 && argv[1][0] == '-') ? argv[1] : NULL;
+    if (mode) {
+        argv++;
+        argc--;
+    }
+    int n = (argc > 1) ? atoi(argv[1]) : 50;
+    if (n <= 0) n = 50;
+    if (mode && strcmp(mode, "--json") == 0) {
+        bench_suite(n, true);
+        return 0;
+    }
+    if (mode && strcmp(mode, "--micro") == 0) {
+        bench_micro(n);
+        return 0;
+    }
+    if (mode) {
+        fprintf(stderr, "usage: %s [--json | --micro] [n]\n", argv[-1]);
+        return 2;
+    }
+
+    u8 (*puzzles)[CELLS] = malloc((size_t)n * CELLS);
+    Board b;
+    board_init(&b);
+    if (!puzzles) return 1;
+
+    // Generation: hole digging runs one uniqueness check per removed clue
+    static const struct { const char *name; BranchHeuristic h; bool singles; } modes[] = {
+        {"first-empty", BRANCH_FIRST_EMPTY, false},
+        {"mrv", BRANCH_MRV, false},
+        {"mrv+lcv", BRANCH_MRV_LCV, false},
+        {"first-empty+singles", BRANCH_FIRST_EMPTY, true},
+        {"mrv+singles", BRANCH_MRV, true},
+    };
+    const int nmodes = (int)(sizeof(modes) / sizeof(modes[0]));
+    static const struct { const char *name; int holes; } levels[] = {
+        {"MEDIUM", MEDIUM_HOLES},
+        {"HARD", HARD_HOLES},
+    };
+    for (int l = 0; l < 2; l++)
+        for (int k = 0; k < nmodes; k++) {
+            char label[48];
+            b.config.branch = modes[k].h;
+            b.config.propagate = modes[k].singles;
+            board_seed(&b, 12345);
+            double t0 = now_sec();
+            for (int i = 0; i < n; i++) {
+                make_puzzle(&b, levels[l].holes);
+                memcpy(puzzles[i], b.values, CELLS);
+            }
+            double dt = now_sec() - t0;
+            snprintf(label, sizeof(label), "generate %s (%s)", levels[l].name, modes[k].name);
+            printf("%-40s %8d puzzles  %10.1f puzzles/sec  %8.3f ms/puzzle\n", label, n, n / dt, dt * 1e3 / n);
+        }
+
+    // Share of HARD puzzles that singles alone solve without branching
+    int solved = 0;
+    for (int i = 0; i < n; i++) {
+        u8 work[CELLS];
+        memcpy(work, puzzles[i], CELLS);
+        solve_singles(work);
+        if (memchr(work, 0, CELLS) == NULL) solved++;
+    }
+    printf("%-40s %8d / %d\n", "HARD solved by singles alone", solved, n);
+
+    bench_count("count_solutions (scan)", count_solutions_scan, puzzles, n);
+    // The later sections, the regression suite included, run on the defaults
+    SearchConfig saved = searchDefaults;
+    for (int k = 0; k < nmodes; k++) {
+        char label[48];
+        searchDefaults.branch = modes[k].h;
+        searchDefaults.propagate = modes[k].singles;
+        snprintf(label, sizeof(label), "count_solutions (%s)", modes[k].name);
+        bench_count(label, count_solutions, puzzles, n);
+    }
+    searchDefaults = saved;
+    dlx_init(&dlx);
+    bench_count("count_solutions (dlx)", count_solutions_dlx, puzzles, n);
+    bench_count("count_solutions (bitboard)", count_solutions_bitboard, puzzles, n);
+
+    bench_dig(n);
+    bench_sliced(n);
+    bench_rng();
+    bench_fill(n);
+    bench_iterative(puzzles, n);
+    bench_enumerate(puzzles[0]);
+    bench_kernels(puzzles, n);
+    bench_batch(puzzles, n);
+    bench_parallel_one();
+    bench_pool();
+    bench_canon(n);
+    bench_corpus(n);
+    bench_rate(n);
+    bench_rated(n);
+    bench_suite(n, false);
+    bench_stats(n);
+
+    free(puzzles);
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "bitboard.h"
+#include <string.h>
+
+#define BAND_MASK 0x7FFFFFFu // 27 cells
+#define ROW_MASK  0x1FFu     // first row of a band
+#define BOX_MASK  0x1C0E07u  // first box of a band
+#define COL_MASK  0x40201u   // first column of a band
+
+static inline u32 row_mask(int pos) { return ROW_MASK << (9 * (pos / 9)); }
+static inline u32 box_mask(int pos) { return BOX_MASK << (3 * ((pos % 9) / 3)); }
+static inline u32 col_mask(int pos) { return COL_MASK << (pos % 9); }
+
+static inline bool single_bit(u32 x) { return x && !(x & (x - 1)); }
+
+// Put digit d (0-based) at position pos of band b and strike it from its peers
+static void place(BandBoard *bb, int d, int b, int pos) {
+    u32 bit = 1u << pos;
+    for (int e = 0; e < 9; e++) bb->cand[e][b] &= ~bit;
+    bb->cand[d][b] &= ~(row_mask(pos) | box_mask(pos));
+    u32 col = ~col_mask(pos);
+    bb->cand[d][0] &= col;
+    bb->cand[d][1] &= col;
+    bb->cand[d][2] &= col;
+    bb->solved[d][b] |= bit;
+    bb->unsolved[b] &= ~bit;
+}
+
+bool bitboard_load(BandBoard *bb, const u8 grid[CELLS]) {
+    for (int b = 0; b < 3; b++) {
+        bb->unsolved[b] = BAND_MASK;
+        for (int d = 0; d < 9; d++) {
+            bb->cand[d][b] = BAND_MASK;
+            bb->solved[d][b] = 0;
+        }
+    }
+    for (int i = 0; i < CELLS; i++) {
+        if (grid[i] == 0) continue;
+        int d = grid[i] - 1, b = i / 27, pos = i % 27;
+        if (grid[i] > 9 || !(bb->cand[d][b] & (1u << pos))) return false;
+        place(bb, d, b, pos);
+    }
+    return true;
+}
+
+// Naked singles for a whole band at once: cells covered by exactly one
+// digit plane. Returns -1 on a cell with no candidates, else placements.
+static int naked_singles(BandBoard *bb) {
+    int placed = 0;
+    for (int b = 0; b < 3; b++) {
+        u32 once = 0, twice = 0;
+        for (int d = 0; d < 9; d++) {
+            twice |= once & bb->cand[d][b];
+            once |= bb->cand[d][b];
+        }
+        if (bb->unsolved[b] & ~once) return -1;
+
+        for (u32 singles = bb->unsolved[b] & ~twice; singles; singles &= singles - 1) {
+            int pos = __builtin_ctz(singles);
+            u32 bit = 1u << pos;
+            for (int d = 0; d < 9; d++)
+                if (bb->cand[d][b] & bit) {
+                    place(bb, d, b, pos);
+                    placed++;
+                    break;
+                }
+        }
+    }
+    return placed;
+}
+
+// Place d at pos unless an earlier placement in this pass removed it
+static int place_if(BandBoard *bb, int d, int b, int pos) {
+    if (!(bb->cand[d][b] & (1u << pos))) return 0;
+    place(bb, d, b, pos);
+    return 1;
+}
+
+// Hidden singles of one digit in its rows, boxes and columns. The three
+// rows of a band are folded into 9-bit column words so boxes and columns
+// are checked with a few word operations.
+// Returns -1 on a contradiction, else the number of changes made.
+static int digit_rules(BandBoard *bb, int d) {
+    int changes = 0;
+    u32 *cand = bb->cand[d];
+    const u32 *solved = bb->solved[d];
+    u32 col_once = 0, col_twice = 0, col_done = 0;
+
+    for (int b = 0; b < 3; b++) {
+        u32 w = cand[b], s = solved[b];
+        u32 rows[3] = {w & ROW_MASK, (w >> 9) & ROW_MASK, w >> 18};
+        u32 done = (s | s >> 9 | s >> 18) & ROW_MASK;
+        u32 once = rows[0] | rows[1] | rows[2];
+        u32 twice = (rows[0] & rows[1]) | (rows[0] & rows[2]) | (rows[1] & rows[2]);
+
+        for (int k = 0; k < 3; k++) {
+            // Row k of the band
+            if (!(s & (ROW_MASK << (9 * k)))) {
+                if (!rows[k]) return -1;
+                if (single_bit(rows[k])) changes += place_if(bb, d, b, 9 * k + __builtin_ctz(rows[k]));
+            }
+            // Box k of the band: one column with a single row in it
+            u32 box_cols = 0x7u << (3 * k);
+            if (!(done & box_cols)) {
+                u32 any = once & box_cols;
+                if (!any) return -1;
+                if (single_bit(any) && !(twice & any)) {
+                    int r = (rows[0] & any) ? 0 : ((rows[1] & any) ? 1 : 2);
+                    changes += place_if(bb, d, b, 9 * r + __builtin_ctz(any));
+                }
+            }
+        }
+
+        col_twice |= (col_once & once) | twice;
+        col_once |= once;
+        col_done |= done;
+    }
+
+    // Columns span the three bands
+    if ((col_once | col_done) != ROW_MASK) return -1;
+    for (u32 singles = col_once & ~col_twice & ~col_done; singles; singles &= singles - 1) {
+        int c = __builtin_ctz(singles);
+        for (int b = 0; b < 3; b++) {
+            u32 m = cand[b] & (COL_MASK << c);
+            if (m) {
+                changes += place_if(bb, d, b, __builtin_ctz(m));
+                break;
+            }
+        }
+    }
+    return changes;
+}
+
+static bool propagate(BandBoard *bb) {
+    u32 seen[9][3]; // digit planes as of their last digit_rules() pass
+    for (int d = 0; d < 9; d++) seen[d][0] = seen[d][1] = seen[d][2] = ~0u;
+
+    for (;;) {
+        int n = naked_singles(bb);
+        if (n < 0) return false;
+        if (n > 0) continue;
+
+        int changes = 0;
+        for (int d = 0; d < 9; d++) {
+            u32 *c = bb->cand[d];
+            if (c[0] == seen[d][0] && c[1] == seen[d][1] && c[2] == seen[d][2]) continue;
+            int h = digit_rules(bb, d);
+            if (h < 0) return false;
+            changes += h;
+            seen[d][0] = c[0];
+            seen[d][1] = c[1];
+            seen[d][2] = c[2];
+        }
+        if (changes == 0) return true;
+    }
+}
+
+typedef struct {
+    int limit;
+    int found;
+    u8 *solution;
+    atomic_int *shared; // solutions found by all threads, NULL when alone
+} BandSearch;
+
+static inline bool search_done(const BandSearch *s) {
+    int total = s->shared ? atomic_load_explicit(s->shared, memory_order_relaxed) : s->found;
+    return total >= s->limit;
+}
+
+static void write_solution(const BandBoard *bb, u8 out[CELLS]) {
+    for (int d = 0; d < 9; d++)
+        for (int b = 0; b < 3; b++)
+            for (u32 m = bb->solved[d][b]; m; m &= m - 1)
+                out[b * 27 + __builtin_ctz(m)] = (u8)(d + 1);
+}
+
+static inline bool board_solved(const BandBoard *bb) {
+    return !(bb->unsolved[0] | bb->unsolved[1] | bb->unsolved[2]);
+}
+
+// Branch on a bivalue cell if there is one, else on the first unsolved cell
+static void choose_branch(const BandBoard *bb, int *band, int *pos) {
+    for (int b = 0; b < 3; b++) {
+        u32 once = 0, twice = 0, thrice = 0;
+        for (int d = 0; d < 9; d++) {
+            u32 c = bb->cand[d][b];
+            thrice |= twice & c;
+            twice |= once & c;
+            once |= c;
+        }
+        u32 pairs = bb->unsolved[b] & twice & ~thrice;
+        if (pairs) {
+            *band = b;
+            *pos = __builtin_ctz(pairs);
+            return;
+        }
+    }
+    for (int b = 0; b < 3; b++)
+        if (bb->unsolved[b]) {
+            *band = b;
+            *pos = __builtin_ctz(bb->unsolved[b]);
+            return;
+        }
+}
+
+static void search(BandBoard *bb, BandSearch *s) {
+    if (!propagate(bb)) return;
+    if (board_solved(bb)) {
+        if (s->found++ == 0 && s->solution) write_solution(bb, s->solution);
+        if (s->shared) atomic_fetch_add_explicit(s->shared, 1, memory_order_relaxed);
+        return;
+    }
+
+    int band = 0, pos = 0;
+    choose_branch(bb, &band, &pos);
+    u32 bit = 1u << pos;
+    for (int d = 0; d < 9 && !search_done(s); d++) {
+        if (!(bb->cand[d][band] & bit)) continue;
+        BandBoard next = *bb;
+        place(&next, d, band, pos);
+        search(&next, s);
+    }
+}
+
+int bitboard_count_solutions(const u8 grid[CELLS], int limit, u8 solution[CELLS]) {
+    BandBoard bb;
+    BandSearch s = {limit, 0, solution, NULL};
+    if (!bitboard_load(&bb, grid)) return 0;
+    search(&bb, &s);
+    return s.found;
+}
+
+int bitboard_count_shared(BandBoard *bb, int limit, atomic_int *shared) {
+    BandSearch s = {limit, 0, NULL, shared};
+    if (!search_done(&s)) search(bb, &s);
+    return s.found;
+}
+
+int bitboard_split(const u8 grid[CELLS], BandBoard *boards, int max_boards, int want, int *found) {
+    int head = 0, tail = 1;
+    *found = 0;
+    if (max_boards < 1 || !bitboard_load(&boards[0], grid)) return 0;
+
+    // Breadth-first, so the queue always holds whole levels of the tree
+    while (head < tail && tail - head < want && tail + 9 <= max_boards) {
+        BandBoard *bb = &boards[head++];
+        if (!propagate(bb)) continue;
+        if (board_solved(bb)) {
+            ++*found;
+            continue;
+        }
+
+        int band = 0, pos = 0;
+        choose_branch(bb, &band, &pos);
+        u32 bit = 1u << pos;
+        for (int d = 0; d < 9; d++) {
+            if (!(bb->cand[d][band] & bit)) continue;
+            boards[tail] = *bb;
+            place(&boards[tail++], d, band, pos);
+        }
+    }
+    memmove(boards, boards + head, sizeof(BandBoard) * (size_t)(tail - head));
+    return tail - head;
+}
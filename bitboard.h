@@ -0,0 +1,33 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "sudoku.h"
+#include <stdatomic.h>
+
+// Band-oriented bitboard: for each digit, one 27-bit word per horizontal
+// band (bit = row_in_band * 9 + col). Constraints are applied to whole
+// bands at a time with word operations.
+typedef struct {
+    u32 cand[9][3];   // cells where each digit may still go
+    u32 solved[9][3]; // cells holding each digit
+    u32 unsolved[3];  // empty cells
+} BandBoard;
+
+// Load a grid; returns false if the givens already conflict
+bool bitboard_load(BandBoard *bb, const u8 grid[CELLS]);
+
+// Same contract as count_solutions() with a caller limit (2 for a
+// uniqueness check). If solution is not NULL it receives the first
+// solution found. grid is not modified.
+int bitboard_count_solutions(const u8 grid[CELLS], int limit, u8 solution[CELLS]);
+
+// Parallel search support. bitboard_split() expands the search tree of
+// grid breadth-first until at least want independent subtrees exist (or
+// max_boards would overflow) and stores them in boards. Solutions met on
+// the way are counted in *found. Returns the number of boards.
+int bitboard_split(const u8 grid[CELLS], BandBoard *boards, int max_boards, int want, int *found);
+// Search one subtree, adding each solution to *shared and stopping once
+// *shared reaches limit. Returns the solutions this call found.
+int bitboard_count_shared(BandBoard *bb, int limit, atomic_int *shared);
+
+#endif // BITBOARD_H
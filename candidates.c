@@ -0,0 +1,271 @@
+#include "candidates.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#if defined(__wasm_simd128__)
+#define HAVE_SIMD128_KERNELS 1
+#include <wasm_simd128.h>
+#endif
+
+// Kernel inputs laid out so each row is one (or two) contiguous vector loads
+typedef struct {
+    u8 grid[CAND_PAD];
+    u16 cols[16];          // column occupancy, lanes 9..15 unused
+    u16 band_boxes[3][16]; // box occupancy of each column within a band
+} KernelInput;
+
+static void kernel_input(KernelInput *in, const u8 grid[CELLS], const CandidateMasks *m) {
+    memset(in, 0, sizeof(*in));
+    memcpy(in->grid, grid, CELLS);
+    memcpy(in->cols, m->cols, sizeof(m->cols));
+    for (int b = 0; b < 3; b++)
+        for (int c = 0; c < 9; c++) in->band_boxes[b][c] = m->boxes[b * 3 + c / 3];
+}
+
+//
+// Scalar
+//
+
+static void all_scalar(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]) {
+    for (int r = 0; r < 9; r++)
+        for (int c = 0; c < 9; c++)
+            out[idx(r, c)] = grid[idx(r, c)] ? 0 : masks_candidates(m, r, c);
+    for (int i = CELLS; i < CAND_PAD; i++) out[i] = 0;
+}
+
+static int singles_scalar(const u16 cands[CAND_PAD], u64 singles[2]) {
+    int n = 0;
+    singles[0] = singles[1] = 0;
+    for (int i = 0; i < CELLS; i++) {
+        u16 v = cands[i];
+        if (v != 0 && (v & (v - 1)) == 0) {
+            singles[i / 64] |= 1ull << (i % 64);
+            n++;
+        }
+    }
+    return n;
+}
+
+//
+// x86: SSE4.1 (8 lanes, two vectors per row) and AVX2 (16 lanes, one per row)
+//
+
+#ifdef HAVE_X86_KERNELS
+__attribute__((target("sse4.1")))
+static void all_sse41(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]) {
+    KernelInput in;
+    kernel_input(&in, grid, m);
+    const __m128i all = _mm_set1_epi16(ALL_CANDIDATES);
+    const __m128i zero = _mm_setzero_si128();
+
+    // Rows are stored in order, so each row's spare lanes are overwritten by the next
+    for (int r = 0; r < 9; r++) {
+        __m128i rv = _mm_set1_epi16((short)m->rows[r]);
+        for (int h = 0; h < 16; h += 8) {
+            __m128i g = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(in.grid + r * 9 + h)));
+            __m128i occ = _mm_or_si128(rv, _mm_loadu_si128((const __m128i *)(in.cols + h)));
+            occ = _mm_or_si128(occ, _mm_loadu_si128((const __m128i *)(in.band_boxes[r / 3] + h)));
+            __m128i cand = _mm_and_si128(_mm_andnot_si128(occ, all), _mm_cmpeq_epi16(g, zero));
+            _mm_storeu_si128((__m128i *)(out + r * 9 + h), cand);
+        }
+    }
+    _mm_storeu_si128((__m128i *)(out + CELLS), zero);
+    _mm_storeu_si128((__m128i *)(out + CAND_PAD - 8), zero);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i singles_mask_sse41(__m128i v) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i t = _mm_and_si128(v, _mm_sub_epi16(v, _mm_set1_epi16(1)));
+    return _mm_andnot_si128(_mm_cmpeq_epi16(v, zero), _mm_cmpeq_epi16(t, zero));
+}
+
+__attribute__((target("sse4.1")))
+static int singles_sse41(const u16 cands[CAND_PAD], u64 singles[2]) {
+    singles[0] = singles[1] = 0;
+    for (int i = 0; i < CAND_PAD; i += 16) {
+        __m128i a = singles_mask_sse41(_mm_loadu_si128((const __m128i *)(cands + i)));
+        __m128i b = singles_mask_sse41(_mm_loadu_si128((const __m128i *)(cands + i + 8)));
+        u64 bits = (u16)_mm_movemask_epi8(_mm_packs_epi16(a, b));
+        singles[i / 64] |= bits << (i % 64);
+    }
+    return __builtin_popcountll(singles[0]) + __builtin_popcountll(singles[1]);
+}
+
+__attribute__((target("avx2")))
+static void all_avx2(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]) {
+    KernelInput in;
+    kernel_input(&in, grid, m);
+    const __m256i all = _mm256_set1_epi16(ALL_CANDIDATES);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i cols = _mm256_loadu_si256((const __m256i *)in.cols);
+
+    for (int r = 0; r < 9; r++) {
+        __m256i g = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(in.grid + r * 9)));
+        __m256i occ = _mm256_or_si256(_mm256_set1_epi16((short)m->rows[r]), cols);
+        occ = _mm256_or_si256(occ, _mm256_loadu_si256((const __m256i *)in.band_boxes[r / 3]));
+        __m256i cand = _mm256_and_si256(_mm256_andnot_si256(occ, all), _mm256_cmpeq_epi16(g, zero));
+        _mm256_storeu_si256((__m256i *)(out + r * 9), cand);
+    }
+    _mm_storeu_si128((__m128i *)(out + CELLS), _mm_setzero_si128());
+    _mm_storeu_si128((__m128i *)(out + CAND_PAD - 8), _mm_setzero_si128());
+}
+
+__attribute__((target("avx2")))
+static int singles_avx2(const u16 cands[CAND_PAD], u64 singles[2]) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    singles[0] = singles[1] = 0;
+    for (int i = 0; i < CAND_PAD; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(cands + i));
+        __m256i t = _mm256_and_si256(v, _mm256_sub_epi16(v, one));
+        __m256i s = _mm256_andnot_si256(_mm256_cmpeq_epi16(v, zero), _mm256_cmpeq_epi16(t, zero));
+        __m128i packed = _mm_packs_epi16(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        u64 bits = (u16)_mm_movemask_epi8(packed);
+        singles[i / 64] |= bits << (i % 64);
+    }
+    return __builtin_popcountll(singles[0]) + __builtin_popcountll(singles[1]);
+}
+#endif // HAVE_X86_KERNELS
+
+//
+// WebAssembly SIMD128
+//
+
+#ifdef HAVE_SIMD128_KERNELS
+static void all_simd128(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]) {
+    KernelInput in;
+    kernel_input(&in, grid, m);
+    const v128_t all = wasm_i16x8_splat(ALL_CANDIDATES);
+    const v128_t zero = wasm_i16x8_splat(0);
+
+    for (int r = 0; r < 9; r++) {
+        v128_t rv = wasm_i16x8_splat((short)m->rows[r]);
+        for (int h = 0; h < 16; h += 8) {
+            v128_t g = wasm_u16x8_load8x8(in.grid + r * 9 + h);
+            v128_t occ = wasm_v128_or(rv, wasm_v128_load(in.cols + h));
+            occ = wasm_v128_or(occ, wasm_v128_load(in.band_boxes[r / 3] + h));
+            v128_t cand = wasm_v128_and(wasm_v128_andnot(all, occ), wasm_i16x8_eq(g, zero));
+            wasm_v128_store(out + r * 9 + h, cand);
+        }
+    }
+    wasm_v128_store(out + CELLS, zero);
+    wasm_v128_store(out + CAND_PAD - 8, zero);
+}
+
+static int singles_simd128(const u16 cands[CAND_PAD], u64 singles[2]) {
+    const v128_t zero = wasm_i16x8_splat(0);
+    const v128_t one = wasm_i16x8_splat(1);
+    singles[0] = singles[1] = 0;
+    for (int i = 0; i < CAND_PAD; i += 8) {
+        v128_t v = wasm_v128_load(cands + i);
+        v128_t t = wasm_v128_and(v, wasm_i16x8_sub(v, one));
+        v128_t s = wasm_v128_andnot(wasm_i16x8_eq(t, zero), wasm_i16x8_eq(v, zero));
+        u64 bits = wasm_i16x8_bitmask(s);
+        singles[i / 64] |= bits << (i % 64);
+    }
+    return __builtin_popcountll(singles[0]) + __builtin_popcountll(singles[1]);
+}
+#endif // HAVE_SIMD128_KERNELS
+
+//
+// Dispatch
+//
+
+// One table per kernel, published through a single atomic pointer so a
+// thread never sees the functions of one kernel with the id of another.
+// Threads that start searching at once may all pick AUTO; they store the
+// same table.
+typedef struct {
+    CandidateKernel id;
+    void (*all)(const u8 *, const CandidateMasks *, u16 *);
+    int (*singles)(const u16 *, u64 *);
+} KernelTable;
+
+static const KernelTable scalar_table = {CAND_KERNEL_SCALAR, all_scalar, singles_scalar};
+#ifdef HAVE_X86_KERNELS
+static const KernelTable sse41_table = {CAND_KERNEL_SSE41, all_sse41, singles_sse41};
+static const KernelTable avx2_table = {CAND_KERNEL_AVX2, all_avx2, singles_avx2};
+#endif
+#ifdef HAVE_SIMD128_KERNELS
+static const KernelTable simd128_table = {CAND_KERNEL_SIMD128, all_simd128, singles_simd128};
+#endif
+
+static _Atomic(const KernelTable *) active = NULL;
+
+bool candidates_use(CandidateKernel kernel) {
+    if (kernel == CAND_KERNEL_AUTO) {
+#if defined(HAVE_SIMD128_KERNELS)
+        kernel = CAND_KERNEL_SIMD128;
+#elif defined(HAVE_X86_KERNELS)
+        if (__builtin_cpu_supports("avx2")) kernel = CAND_KERNEL_AVX2;
+        else if (__builtin_cpu_supports("sse4.1")) kernel = CAND_KERNEL_SSE41;
+        else kernel = CAND_KERNEL_SCALAR;
+#else
+        kernel = CAND_KERNEL_SCALAR;
+#endif
+    }
+
+    const KernelTable *table;
+    switch (kernel) {
+    case CAND_KERNEL_SCALAR:
+        table = &scalar_table;
+        break;
+#ifdef HAVE_X86_KERNELS
+    case CAND_KERNEL_SSE41:
+        if (!__builtin_cpu_supports("sse4.1")) return false;
+        table = &sse41_table;
+        break;
+    case CAND_KERNEL_AVX2:
+        if (!__builtin_cpu_supports("avx2")) return false;
+        table = &avx2_table;
+        break;
+#endif
+#ifdef HAVE_SIMD128_KERNELS
+    case CAND_KERNEL_SIMD128:
+        table = &simd128_table;
+        break;
+#endif
+    default:
+        return false;
+    }
+    atomic_store_explicit(&active, table, memory_order_release);
+    return true;
+}
+
+// The selected kernel, choosing the best one on first use
+static const KernelTable *kernel_table(void) {
+    const KernelTable *table = atomic_load_explicit(&active, memory_order_acquire);
+    if (!table) {
+        candidates_use(CAND_KERNEL_AUTO);
+        table = atomic_load_explicit(&active, memory_order_acquire);
+    }
+    return table;
+}
+
+CandidateKernel candidates_kernel(void) {
+    return kernel_table()->id;
+}
+
+const char *candidates_kernel_name(CandidateKernel kernel) {
+    switch (kernel) {
+    case CAND_KERNEL_SCALAR:  return "scalar";
+    case CAND_KERNEL_SSE41:   return "sse4.1";
+    case CAND_KERNEL_AVX2:    return "avx2";
+    case CAND_KERNEL_SIMD128: return "simd128";
+    default:                  return "auto";
+    }
+}
+
+void candidates_all(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]) {
+    kernel_table()->all(grid, m, out);
+}
+
+int candidates_naked_singles(const u16 cands[CAND_PAD], u64 singles[2]) {
+    return kernel_table()->singles(cands, singles);
+}
@@ -0,0 +1,32 @@
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+#include "sudoku.h"
+
+// Candidate arrays are padded so every kernel can use whole 16-lane stores
+#define CAND_PAD 96
+
+typedef enum {
+    CAND_KERNEL_AUTO,   // best kernel supported by this CPU/build
+    CAND_KERNEL_SCALAR,
+    CAND_KERNEL_SSE41,
+    CAND_KERNEL_AVX2,
+    CAND_KERNEL_SIMD128 // WebAssembly, chosen at compile time with -msimd128
+} CandidateKernel;
+
+// Select a kernel; returns false if it is not available in this build/CPU.
+// Without a call the best kernel is picked on first use, safely from any
+// thread. Call it only while no search is running: a search in flight may
+// switch kernels between two calls.
+bool candidates_use(CandidateKernel kernel);
+CandidateKernel candidates_kernel(void);
+const char *candidates_kernel_name(CandidateKernel kernel);
+
+// Legal digits of every cell at once; filled cells get 0
+void candidates_all(const u8 grid[CELLS], const CandidateMasks *m, u16 out[CAND_PAD]);
+
+// Bitmap (cell i -> bit i % 64 of singles[i / 64]) of cells with exactly
+// one candidate. Returns the number of such cells.
+int candidates_naked_singles(const u16 cands[CAND_PAD], u64 singles[2]);
+
+#endif // CANDIDATES_H
@@ -0,0 +1,464 @@
+#include "canon.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define UNSEEN 9 // orow of a digit no fixed row holds yet
+
+// One symmetry under construction: rows 0..k-1 of the output are fixed.
+// Columns form an ordered partition into classes that read the same in
+// every fixed row, so any order within a class gives the same prefix; cols
+// holds one order and later rows split the classes. Stacks are grouped the
+// same way. A digit's label counts the digits seen before it, so it is only
+// known once the column it was first seen in has settled into its place.
+typedef struct {
+    u8 rows[9];  // output row -> source row
+    u8 cols[9];  // output column -> source column, one order of each class
+    u8 where[9]; // source column -> output column, the inverse of cols
+    u8 orow[10]; // source digit -> output row it first appears in, UNSEEN if none
+    u8 ocol[10]; // source column of that first appearance
+    u8 map[10];  // source digit -> label, 0 until its column settles
+    u8 first[9]; // output row -> label of the first digit it shows first
+    u16 fresh[9]; // output row -> output columns showing a digit first
+    u8 next;     // label of the next new digit
+    u8 t;        // reads the transposed source
+    u8 bands;    // source bands already used
+    u8 sbrk;     // bit o: a stack class starts at output stack o (bit 3 always set)
+    u16 cbrk;    // bit p: a column class starts at output column p (bits 0, 3, 6, 9 always set)
+} CanonState;
+
+struct Canonizer {
+    CanonState *cur, *nxt;
+    size_t cap;
+};
+
+Canonizer *canon_create(void) {
+    Canonizer *c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+    c->cap = 4096;
+    c->cur = malloc(c->cap * sizeof(CanonState));
+    c->nxt = malloc(c->cap * sizeof(CanonState));
+    if (!c->cur || !c->nxt) {
+        canon_destroy(c);
+        return NULL;
+    }
+    return c;
+}
+
+void canon_destroy(Canonizer *c) {
+    if (!c) return;
+    free(c->cur);
+    free(c->nxt);
+    free(c);
+}
+
+// Room for n + 1 states in both buffers
+static bool reserve(Canonizer *c, size_t n) {
+    if (n < c->cap) return true;
+    if (c->cap >= CANON_MAX_STATES) return false;
+    size_t cap = c->cap * 2;
+    CanonState *cur = realloc(c->cur, cap * sizeof(CanonState));
+    if (!cur) return false;
+    c->cur = cur;
+    CanonState *nxt = realloc(c->nxt, cap * sizeof(CanonState));
+    if (!nxt) return false;
+    c->nxt = nxt;
+    c->cap = cap;
+    return true;
+}
+
+// First and one-past-last member of the class holding p, for brk masks
+// with a bit at each class start and one past the end
+static int class_start(unsigned brk, int p) {
+    return 31 - __builtin_clz(brk & ((2u << p) - 1));
+}
+
+static int class_end(unsigned brk, int p) {
+    return p + 1 + __builtin_ctz(brk >> (p + 1));
+}
+
+static void swap_cols(CanonState *st, int a, int b) {
+    u8 tmp = st->cols[a];
+    st->cols[a] = st->cols[b];
+    st->cols[b] = tmp;
+    st->where[st->cols[a]] = (u8)a;
+    st->where[st->cols[b]] = (u8)b;
+}
+
+// Swap output stacks a and b, both of one stack class and so laid out alike
+static void swap_stacks(CanonState *st, int a, int b) {
+    for (int i = 0; i < 3; i++) swap_cols(st, a * 3 + i, b * 3 + i);
+}
+
+// Label of a digit first seen at output column pos of output row r: one
+// more than the digits first seen before it. The columns of a class read
+// alike, so it does not depend on the order chosen within classes.
+static u8 label_at(const CanonState *st, int r, int pos) {
+    // Bit count of a 9-bit mask without a library call on baseline x86-64
+    unsigned x = st->fresh[r] & ((1u << pos) - 1);
+    x -= (x >> 1) & 0x5555;
+    x = (x & 0x3333) + ((x >> 2) & 0x3333);
+    x = (x + (x >> 4)) & 0x0F0F;
+    return (u8)(st->first[r] + ((x + (x >> 8)) & 0x1F));
+}
+
+// Smallest value the column at output column j can show at output column
+// p, the start of its class: empty cells read 0, new digits next and a seen
+// digit its label, placing the column that digit was first seen in as
+// early as its classes still allow
+static u8 value_at(const CanonState *st, const u8 *row, int j, int p) {
+    u8 v = row[st->cols[j]];
+    if (!v) return 0;
+    if (st->orow[v] == UNSEEN) return st->next;
+    if (st->map[v]) return st->map[v];
+    int pc = st->where[st->ocol[v]];
+    int a = class_start(st->cbrk, pc);
+    int pos = p + 1; // right after this column in its own class
+    if (a != p) {
+        int oc = pc / 3;
+        pos = class_start(st->sbrk, oc) * 3 + a - oc * 3;
+    }
+    return label_at(st, st->orow[v], pos);
+}
+
+// Move col to the earliest place value_at() assumed and split it off its
+// stack and column classes
+static void settle(CanonState *st, int col) {
+    int pc = st->where[col];
+    int oc = pc / 3;
+    int so = class_start(st->sbrk, oc);
+    if (so != oc) {
+        swap_stacks(st, so, oc);
+        pc += (so - oc) * 3;
+    }
+    st->sbrk |= (u8)(2u << so);
+    int a = class_start(st->cbrk, pc);
+    swap_cols(st, a, pc);
+    st->cbrk |= (u16)(2u << a);
+}
+
+// Put the column at output column j first in the class starting at p, its
+// value there being val, and settle where its digit was first seen
+static void place(CanonState *st, const u8 *row, int p, int j, u8 val) {
+    u8 v = row[st->cols[j]];
+    swap_cols(st, p, j);
+    st->cbrk |= (u16)(2u << p);
+    if (!st->map[v]) {
+        settle(st, st->ocol[v]);
+        st->map[v] = val;
+    }
+}
+
+// Check value v at output column p against the best row so far: false if
+// it is worse, restarting the tied states on a new best
+static bool take(u8 v, int p, u8 brow[9], size_t *m) {
+    if (v > brow[p]) return false;
+    if (v < brow[p]) {
+        brow[p] = v;
+        memset(brow + p + 1, 0xFF, (size_t)(8 - p));
+        *m = 0;
+    }
+    return true;
+}
+
+// Empty cells of each class in output columns [p, q) first, splitting them
+// off; the rest are new digits, which keep their class and label by place.
+// False if the row falls behind the best.
+static bool take_plain(CanonState *st, const u8 *row, int k, int p, int q, u8 brow[9], size_t *m) {
+    for (int a = p; a < q; a = class_end(st->cbrk, a)) {
+        int e = class_end(st->cbrk, a), z = a;
+        for (int j = a; j < e; j++)
+            if (!row[st->cols[j]]) swap_cols(st, j, z++);
+        if (z > a && z < e) st->cbrk |= (u16)(1u << z);
+    }
+    for (int j = p; j < q; j++) {
+        u8 v = row[st->cols[j]];
+        if (!take(v ? st->next : 0, j, brow, m)) return false;
+        if (!v) continue;
+        st->orow[v] = (u8)k;
+        st->ocol[v] = st->cols[j];
+        st->fresh[k] |= (u16)(1u << j);
+        st->next++;
+    }
+    return true;
+}
+
+// Order the tied stacks [o, e) by where their empty cells fall in row k,
+// when that row shows only empty cells and new digits there: stacks that
+// still read alike stay tied. False if some stack shows a seen digit.
+static bool order_plain_stacks(CanonState *st, const u8 *row, int o, int e) {
+    int key[3];
+    for (int s = o; s < e; s++) {
+        key[s] = 0;
+        for (int a = s * 3; a < s * 3 + 3; a = class_end(st->cbrk, a)) {
+            int b = class_end(st->cbrk, a), z = 0;
+            for (int j = a; j < b; j++) {
+                u8 v = row[st->cols[j]];
+                if (v && st->orow[v] != UNSEEN) return false;
+                z += !v;
+            }
+            for (int j = a + z; j < b; j++) key[s] |= 4 >> (j - s * 3);
+        }
+    }
+    for (int s = o + 1; s < e; s++)
+        for (int r = s; r > o && key[r] < key[r - 1]; r--) {
+            swap_stacks(st, r, r - 1);
+            int tmp = key[r];
+            key[r] = key[r - 1];
+            key[r - 1] = tmp;
+        }
+    for (int s = o + 1; s < e; s++)
+        if (key[s] != key[s - 1]) st->sbrk |= (u8)(1u << s);
+    return true;
+}
+
+// Fill output row k of *st from output column p on, column class by column
+// class, pushing onto nxt every completion that ties the best row k so far.
+// Classes only branch where their columns give equal values that tell them
+// apart later: empty cells and new digits keep a class together. *st is
+// used as scratch.
+static bool fill_row(Canonizer *c, const u8 src[2][CELLS], CanonState *st, int k, int p, u8 brow[9], size_t *m) {
+    const u8 *row = &src[st->t][idx(st->rows[k], 0)];
+    while (p < 9) {
+        int o = p / 3;
+        if (p % 3 == 0 && !(st->sbrk & (2u << o))) {
+            int e = class_end(st->sbrk, o);
+            if (order_plain_stacks(st, row, o, e)) {
+                if (!take_plain(st, row, k, p, e * 3, brow, m)) return true;
+                p = e * 3;
+                continue;
+            }
+            // A seen digit tells the tied stacks apart: try each one here
+            for (int s = e - 1; s > o; s--) {
+                CanonState alt = *st;
+                swap_stacks(&alt, o, s);
+                alt.sbrk |= (u8)(2u << o);
+                if (!fill_row(c, src, &alt, k, p, brow, m)) return false;
+            }
+            st->sbrk |= (u8)(2u << o);
+            continue;
+        }
+
+        int q = class_end(st->cbrk, p);
+        if (q == p + 1) {
+            // A settled column
+            u8 v = row[st->cols[p]];
+            u8 val = value_at(st, row, p, p);
+            if (!take(val, p, brow, m)) return true;
+            if (v && !st->map[v]) {
+                if (val == st->next) {
+                    st->orow[v] = (u8)k;
+                    st->ocol[v] = st->cols[p];
+                    st->fresh[k] |= (u16)(1u << p);
+                    st->next++;
+                } else {
+                    settle(st, st->ocol[v]);
+                }
+                st->map[v] = val;
+            }
+            p++;
+            continue;
+        }
+
+        u8 vals[9], best = 0xFF;
+        for (int j = p; j < q; j++) {
+            vals[j] = value_at(st, row, j, p);
+            if (vals[j] < best) best = vals[j];
+        }
+        if (best == st->next) {
+            // Only new digits left: the class stays tied
+            if (!take_plain(st, row, k, p, q, brow, m)) return true;
+            p = q;
+            continue;
+        }
+        if (best == 0) {
+            // Empty cells first, still tied among themselves
+            int z = p;
+            for (int j = p; j < q; j++)
+                if (!vals[j]) swap_cols(st, j, z++);
+            if (z < q) st->cbrk |= (u16)(1u << z);
+            for (; p < z; p++)
+                if (!take(0, p, brow, m)) return true;
+            continue;
+        }
+        if (!take(best, p, brow, m)) return true;
+
+        // Each column giving the smallest seen label comes next; the first
+        // one goes on in *st
+        int first = p;
+        while (vals[first] != best) first++;
+        for (int j = q - 1; j >= first; j--) {
+            if (vals[j] != best) continue;
+            CanonState alt;
+            CanonState *s = st;
+            if (j != first) {
+                alt = *st;
+                s = &alt;
+            }
+            place(s, row, p, j, best);
+            if (j != first && !fill_row(c, src, &alt, k, p + 1, brow, m)) return false;
+        }
+        p++;
+    }
+    if (!reserve(c, *m)) return false;
+    c->nxt[(*m)++] = *st;
+    return true;
+}
+
+// Try every row that may come at output row k after sp
+static bool extend(Canonizer *c, const u8 src[2][CELLS], const CanonState *sp, int k, u8 brow[9], size_t *m) {
+    const CanonState st = *sp; // reserve() may move the buffer sp is in
+    // Rows that may come next: any row of an unused band when a band
+    // starts, else the rows of the current band not placed yet
+    u8 cand[9];
+    int ncand = 0;
+    if (k % 3 == 0) {
+        for (int b = 0; b < 3; b++)
+            if (!(st.bands & (1u << b)))
+                for (int j = 0; j < 3; j++) cand[ncand++] = (u8)(b * 3 + j);
+    } else {
+        int b = st.rows[k - 1] / 3;
+        for (int j = 0; j < 3; j++) {
+            u8 r = (u8)(b * 3 + j);
+            bool used = false;
+            for (int q = k - k % 3; q < k; q++) used |= st.rows[q] == r;
+            if (!used) cand[ncand++] = r;
+        }
+    }
+
+    for (int q = 0; q < ncand; q++) {
+        CanonState ns = st;
+        ns.rows[k] = cand[q];
+        ns.bands |= (u8)(1u << (cand[q] / 3));
+        ns.first[k] = ns.next;
+        if (!fill_row(c, src, &ns, k, 0, brow, m)) return false;
+    }
+    return true;
+}
+
+bool canon_minlex(Canonizer *c, const u8 grid[CELLS], u8 out[CELLS]) {
+    u8 src[2][CELLS];
+    memcpy(src[0], grid, CELLS);
+    for (int r = 0; r < 9; r++)
+        for (int col = 0; col < 9; col++) src[1][idx(col, r)] = grid[idx(r, col)];
+
+    // Both orientations, every column in its stack's class and the three
+    // stacks tied
+    CanonState root;
+    memset(&root, 0, sizeof(root));
+    for (int i = 0; i < 9; i++) root.cols[i] = root.where[i] = (u8)i;
+    memset(root.orow, UNSEEN, sizeof(root.orow));
+    root.next = 1;
+    root.sbrk = 0x9;
+    root.cbrk = 0x249;
+    c->cur[0] = root;
+    c->cur[1] = root;
+    c->cur[1].t = 1;
+    size_t n = 2;
+
+    u8 best[CELLS];
+    for (int k = 0; k < 9; k++) {
+        u8 *brow = &best[k * 9];
+        memset(brow, 0xFF, 9);
+        size_t m = 0;
+
+        for (size_t i = 0; i < n; i++)
+            if (!extend(c, src, &c->cur[i], k, brow, &m)) return false;
+
+        CanonState *tmp = c->cur;
+        c->cur = c->nxt;
+        c->nxt = tmp;
+        n = m;
+    }
+    memcpy(out, best, CELLS);
+    return true;
+}
+
+//
+// Dedupe set: open addressing over nibble-packed canonical forms
+//
+
+#define PACKED ((CELLS + 1) / 2)
+
+typedef struct {
+    u64 hash; // 0 marks an empty slot
+    u8 packed[PACKED];
+} CanonEntry;
+
+struct CanonSet {
+    Canonizer *canon;
+    CanonEntry *slots;
+    size_t cap; // power of two
+    size_t size;
+};
+
+static u64 hash_grid(const u8 packed[PACKED]) {
+    u64 h = 1469598103934665603ull; // FNV-1a
+    for (int i = 0; i < PACKED; i++) {
+        h ^= packed[i];
+        h *= 1099511628211ull;
+    }
+    return h ? h : 1;
+}
+
+CanonSet *canon_set_create(void) {
+    CanonSet *set = calloc(1, sizeof(*set));
+    if (!set) return NULL;
+    set->cap = 1024;
+    set->canon = canon_create();
+    set->slots = calloc(set->cap, sizeof(CanonEntry));
+    if (!set->canon || !set->slots) {
+        canon_set_destroy(set);
+        return NULL;
+    }
+    return set;
+}
+
+void canon_set_destroy(CanonSet *set) {
+    if (!set) return;
+    canon_destroy(set->canon);
+    free(set->slots);
+    free(set);
+}
+
+static CanonEntry *find_slot(CanonEntry *slots, size_t cap, u64 hash, const u8 packed[PACKED]) {
+    size_t i = (size_t)hash & (cap - 1);
+    while (slots[i].hash != 0) {
+        if (slots[i].hash == hash && memcmp(slots[i].packed, packed, PACKED) == 0) break;
+        i = (i + 1) & (cap - 1);
+    }
+    return &slots[i];
+}
+
+static bool grow(CanonSet *set) {
+    size_t cap = set->cap * 2;
+    CanonEntry *slots = calloc(cap, sizeof(CanonEntry));
+    if (!slots) return false;
+    for (size_t i = 0; i < set->cap; i++)
+        if (set->slots[i].hash != 0) *find_slot(slots, cap, set->slots[i].hash, set->slots[i].packed) = set->slots[i];
+    free(set->slots);
+    set->slots = slots;
+    set->cap = cap;
+    return true;
+}
+
+bool canon_set_insert(CanonSet *set, const u8 grid[CELLS]) {
+    u8 form[CELLS], packed[PACKED] = {0};
+    if (!canon_minlex(set->canon, grid, form)) return false;
+    for (int i = 0; i < CELLS; i++) packed[i / 2] |= (u8)(form[i] << (i % 2 ? 4 : 0));
+
+    u64 hash = hash_grid(packed);
+    CanonEntry *e = find_slot(set->slots, set->cap, hash, packed);
+    if (e->hash != 0) return false;
+    if ((set->size + 1) * 2 > set->cap) {
+        if (!grow(set)) return false;
+        e = find_slot(set->slots, set->cap, hash, packed);
+    }
+    e->hash = hash;
+    memcpy(e->packed, packed, PACKED);
+    set->size++;
+    return true;
+}
+
+size_t canon_set_size(const CanonSet *set) {
+    return set->size;
+}
@@ -0,0 +1,39 @@
+#ifndef CANON_H
+#define CANON_H
+
+#include "sudoku.h"
+#include <stddef.h>
+
+// Minlex canonical form: the lexicographically smallest row-major string a
+// puzzle can be turned into by transposition, band and row-within-band
+// permutations, stack and column-within-stack permutations and digit
+// relabeling (0 stays empty). Two puzzles are equivalent iff their
+// canonical forms are equal.
+//
+// The search keeps every symmetry tied for the smallest prefix and extends
+// them one row at a time. Columns within a stack, and the stacks, that read
+// the same so far stay unordered classes which later rows split, so the
+// scratch space grows with the puzzle's own symmetry rather than with the
+// 1296 column orders. Reuse one Canonizer per thread.
+typedef struct Canonizer Canonizer;
+
+Canonizer *canon_create(void); // NULL on failure
+void canon_destroy(Canonizer *c);
+
+// Write the canonical form of grid to out (may alias grid). Returns false
+// if the tied symmetries would not fit in CANON_MAX_STATES, which only
+// happens for nearly empty grids with many symmetries.
+#define CANON_MAX_STATES (1 << 20)
+bool canon_minlex(Canonizer *c, const u8 grid[CELLS], u8 out[CELLS]);
+
+// Set of canonical forms for dropping duplicate puzzles from a stream
+typedef struct CanonSet CanonSet;
+
+CanonSet *canon_set_create(void); // NULL on failure
+void canon_set_destroy(CanonSet *set);
+// Canonicalize grid and add it; true if no equivalent puzzle was in the
+// set. False for duplicates and on failure (see canon_minlex()).
+bool canon_set_insert(CanonSet *set, const u8 grid[CELLS]);
+size_t canon_set_size(const CanonSet *set);
+
+#endif // CANON_H
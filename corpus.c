@@ -0,0 +1,250 @@
+#define _POSIX_C_SOURCE 199309L
+#include "corpus.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define HEADER_FIXED 8    // magic, version, section count
+#define SECTION_BYTES 24  // one index entry
+#define MAX_SECTIONS (CELLS + 1)
+#define MAX_DIGIT_BYTES ((CELLS + 1) / 2)
+
+static u32 fnv1a(const u8 *p, size_t n) {
+    u32 h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void put_u16(u8 *p, u16 v) {
+    p[0] = (u8)v;
+    p[1] = (u8)(v >> 8);
+}
+
+static void put_u32(u8 *p, u32 v) {
+    for (int i = 0; i < 4; i++) p[i] = (u8)(v >> (8 * i));
+}
+
+static void put_u64(u8 *p, u64 v) {
+    for (int i = 0; i < 8; i++) p[i] = (u8)(v >> (8 * i));
+}
+
+static u16 get_u16(const u8 *p) {
+    return (u16)(p[0] | p[1] << 8);
+}
+
+static u32 get_u32(const u8 *p) {
+    return (u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 | (u32)p[3] << 24;
+}
+
+static u64 get_u64(const u8 *p) {
+    u64 v = 0;
+    for (int i = 7; i >= 0; i--) v = v << 8 | p[i];
+    return v;
+}
+
+//
+// Read side
+//
+
+typedef struct {
+    const u8 *records; // NULL if the corpus has no puzzle with these holes
+    u64 count;
+    u32 size;
+} CorpusSection;
+
+struct Corpus {
+    const u8 *map;
+    size_t len;
+    CorpusSection sections[MAX_SECTIONS]; // by hole count
+};
+
+Corpus *corpus_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (u64)st.st_size < HEADER_FIXED + 4) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    const u8 *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    Corpus *c = calloc(1, sizeof(*c));
+    if (!c) {
+        munmap((void *)map, len);
+        return NULL;
+    }
+    c->map = map;
+    c->len = len;
+
+    int n = get_u16(map + 6);
+    size_t header = HEADER_FIXED + (size_t)n * SECTION_BYTES;
+    bool ok = memcmp(map, "SDKC", 4) == 0 && get_u16(map + 4) == CORPUS_VERSION && n <= MAX_SECTIONS &&
+              header + 4 <= len && get_u32(map + header) == fnv1a(map, header);
+    for (int i = 0; ok && i < n; i++) {
+        const u8 *e = map + HEADER_FIXED + (size_t)i * SECTION_BYTES;
+        int holes = e[0];
+        u32 size = get_u32(e + 4);
+        u64 offset = get_u64(e + 8), count = get_u64(e + 16);
+        // Overflow-safe form of offset + count * size <= len
+        ok = holes <= CELLS && c->sections[holes].records == NULL && size >= CORPUS_MASK_BYTES + 4 &&
+             size <= CORPUS_MASK_BYTES + MAX_DIGIT_BYTES + 4 &&
+             offset >= header + 4 && offset <= len && count <= (len - offset) / size;
+        if (!ok) break;
+        c->sections[holes] = (CorpusSection){map + offset, count, size};
+    }
+    if (!ok) {
+        corpus_close(c);
+        return NULL;
+    }
+    return c;
+}
+
+void corpus_close(Corpus *c) {
+    if (!c) return;
+    munmap((void *)c->map, c->len);
+    free(c);
+}
+
+u64 corpus_count(const Corpus *c, int holes) {
+    if (holes < 0 || holes > CELLS) return 0;
+    return c->sections[holes].count;
+}
+
+bool corpus_get(const Corpus *c, int holes, u64 k, u8 grid[CELLS]) {
+    if (holes < 0 || holes > CELLS) return false;
+    const CorpusSection *s = &c->sections[holes];
+    if (k >= s->count) return false;
+    const u8 *rec = s->records + k * s->size;
+    if (get_u32(rec + s->size - 4) != fnv1a(rec, s->size - 4)) return false;
+
+    // Walk the given cells through the mask a word at a time
+    const u8 *digits = rec + CORPUS_MASK_BYTES;
+    int room = (int)(s->size - CORPUS_MASK_BYTES - 4) * 2, clue = 0;
+    u8 bad = 0;
+    memset(grid, 0, CELLS);
+    for (int w = 0; w < CORPUS_MASK_BYTES; w += 8) {
+        u64 bits = 0;
+        for (int j = 0; j < 8 && w + j < CORPUS_MASK_BYTES; j++) bits |= (u64)rec[w + j] << (8 * j);
+        while (bits) {
+            int i = w * 8 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            if (i >= CELLS || clue == room) return false;
+            u8 v = (u8)(digits[clue / 2] >> (clue % 2 * 4) & 0xF);
+            bad |= (u8)(v == 0 || v > 9);
+            grid[i] = v;
+            clue++;
+        }
+    }
+    return !bad;
+}
+
+//
+// Write side
+//
+
+// Records are kept at full width and cut down to the section's widest
+// digit run when written
+#define WIDE_BYTES (CORPUS_MASK_BYTES + MAX_DIGIT_BYTES)
+
+typedef struct {
+    u8 *bytes; // records, WIDE_BYTES each
+    u64 count;
+    u64 cap;   // records
+    int clues; // most clues in any record
+} BuilderSection;
+
+struct CorpusBuilder {
+    BuilderSection sections[MAX_SECTIONS];
+};
+
+CorpusBuilder *corpus_builder_create(void) {
+    return calloc(1, sizeof(CorpusBuilder));
+}
+
+void corpus_builder_destroy(CorpusBuilder *cb) {
+    if (!cb) return;
+    for (int h = 0; h < MAX_SECTIONS; h++) free(cb->sections[h].bytes);
+    free(cb);
+}
+
+static u32 record_bytes(const BuilderSection *s) {
+    return (u32)(CORPUS_MASK_BYTES + (s->clues + 1) / 2 + 4);
+}
+
+bool corpus_builder_add(CorpusBuilder *cb, int holes, const u8 grid[CELLS]) {
+    if (holes < 0 || holes > CELLS) return false;
+    for (int i = 0; i < CELLS; i++)
+        if (grid[i] > 9) return false;
+    BuilderSection *s = &cb->sections[holes];
+    if (s->count == s->cap) {
+        u64 cap = s->cap ? s->cap * 2 : 256;
+        u8 *bytes = realloc(s->bytes, cap * WIDE_BYTES);
+        if (!bytes) return false;
+        s->bytes = bytes;
+        s->cap = cap;
+    }
+
+    u8 *rec = s->bytes + s->count * WIDE_BYTES;
+    memset(rec, 0, WIDE_BYTES);
+    u8 *digits = rec + CORPUS_MASK_BYTES;
+    int clue = 0;
+    for (int i = 0; i < CELLS; i++)
+        if (grid[i]) {
+            rec[i / 8] |= (u8)(1u << (i % 8));
+            digits[clue / 2] |= (u8)(grid[i] << (clue % 2 ? 4 : 0));
+            clue++;
+        }
+    if (clue > s->clues) s->clues = clue;
+    s->count++;
+    return true;
+}
+
+bool corpus_builder_write(const CorpusBuilder *cb, const char *path) {
+    u8 header[HEADER_FIXED + MAX_SECTIONS * SECTION_BYTES + 4];
+    int n = 0;
+    for (int h = 0; h < MAX_SECTIONS; h++) n += cb->sections[h].count > 0;
+    size_t len = HEADER_FIXED + (size_t)n * SECTION_BYTES;
+
+    memcpy(header, "SDKC", 4);
+    put_u16(header + 4, CORPUS_VERSION);
+    put_u16(header + 6, (u16)n);
+    u64 offset = len + 4;
+    u8 *e = header + HEADER_FIXED;
+    for (int h = 0; h < MAX_SECTIONS; h++) {
+        const BuilderSection *s = &cb->sections[h];
+        if (s->count == 0) continue;
+        memset(e, 0, SECTION_BYTES);
+        e[0] = (u8)h;
+        put_u32(e + 4, record_bytes(s));
+        put_u64(e + 8, offset);
+        put_u64(e + 16, s->count);
+        offset += s->count * record_bytes(s);
+        e += SECTION_BYTES;
+    }
+    put_u32(header + len, fnv1a(header, len));
+
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(header, 1, len + 4, f) == len + 4;
+    for (int h = 0; ok && h < MAX_SECTIONS; h++) {
+        const BuilderSection *s = &cb->sections[h];
+        u32 size = record_bytes(s);
+        for (u64 k = 0; ok && k < s->count; k++) {
+            u8 rec[WIDE_BYTES + 4];
+            memcpy(rec, s->bytes + k * WIDE_BYTES, size - 4);
+            put_u32(rec + size - 4, fnv1a(rec, size - 4));
+            ok = fwrite(rec, 1, size, f) == size;
+        }
+    }
+    return fclose(f) == 0 && ok;
+}
@@ -0,0 +1,48 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "sudoku.h"
+
+// On-disk puzzle corpus. Puzzles are grouped into one section per
+// difficulty, keyed by the hole count they were generated for (Board.holes;
+// digging may stop with fewer). A section is a run of fixed-size records,
+// so puzzle k of a difficulty is at a computed offset. All integers are
+// little-endian.
+//
+//   header   "SDKC", u16 version, u16 sections,
+//            sections x {u8 holes, u8 pad[3], u32 record size,
+//                        u64 offset, u64 count},
+//            u32 FNV-1a of the header so far
+//   record   81-bit clue mask (11 bytes, bit i = cell i is given),
+//            the clue digits nibble-packed in cell order, zero-padded to
+//            the most clues in the section,
+//            u32 FNV-1a of the bytes before it
+//
+// A HARD record is about 28 bytes and an EASY one 43, against 81 for a grid.
+#define CORPUS_VERSION 1
+#define CORPUS_MASK_BYTES ((CELLS + 7) / 8)
+
+// Read side: the file is mapped read-only and records are decoded in place
+typedef struct Corpus Corpus;
+
+// NULL if the file cannot be mapped or its header is inconsistent
+Corpus *corpus_open(const char *path);
+void corpus_close(Corpus *c);
+// Puzzles stored for this difficulty, 0 if none
+u64 corpus_count(const Corpus *c, int holes);
+// Decode puzzle k of this difficulty into grid. False when k is out of
+// range or the record fails its checksum.
+bool corpus_get(const Corpus *c, int holes, u64 k, u8 grid[CELLS]);
+
+// Write side: puzzles are collected in memory, sorted into sections by
+// difficulty, and written out in one go
+typedef struct CorpusBuilder CorpusBuilder;
+
+CorpusBuilder *corpus_builder_create(void); // NULL on failure
+void corpus_builder_destroy(CorpusBuilder *cb);
+// Append grid to the section for holes (0..CELLS). False on allocation
+// failure or if grid holds a value above 9.
+bool corpus_builder_add(CorpusBuilder *cb, int holes, const u8 grid[CELLS]);
+bool corpus_builder_write(const CorpusBuilder *cb, const char *path);
+
+#endif // CORPUS_H
@@ -0,0 +1,138 @@
+#include "dlx.h"
+#include <limits.h>
+#include <string.h>
+
+#define ROOT 0
+
+static inline int row_node(int cell, int val) {
+    return 1 + DLX_COLS + (cell * 9 + (val - 1)) * 4;
+}
+
+void dlx_init(DlxSolver *s) {
+    memset(s, 0, sizeof(*s));
+
+    // Header list: root plus one header per column
+    for (int c = 0; c <= DLX_COLS; c++) {
+        s->left[c] = (short)(c == 0 ? DLX_COLS : c - 1);
+        s->right[c] = (short)(c == DLX_COLS ? 0 : c + 1);
+        s->up[c] = s->down[c] = (short)c;
+        s->column[c] = (short)c;
+    }
+
+    for (int cell = 0; cell < CELLS; cell++) {
+        int r = cell / 9, c = cell % 9;
+        for (int val = 1; val <= 9; val++) {
+            int cols[4] = {
+                1 + cell,
+                1 + CELLS + r * 9 + (val - 1),
+                1 + CELLS * 2 + c * 9 + (val - 1),
+                1 + CELLS * 3 + box_of(r, c) * 9 + (val - 1),
+            };
+            int first = row_node(cell, val);
+            for (int k = 0; k < 4; k++) {
+                int n = first + k;
+                int h = cols[k];
+                s->column[n] = (short)h;
+                s->left[n] = (short)(first + (k + 3) % 4);
+                s->right[n] = (short)(first + (k + 1) % 4);
+                s->up[n] = s->up[h];
+                s->down[n] = (short)h;
+                s->down[s->up[h]] = (short)n;
+                s->up[h] = (short)n;
+                s->size[h]++;
+            }
+        }
+    }
+}
+
+static void cover(DlxSolver *s, int c) {
+    s->right[s->left[c]] = s->right[c];
+    s->left[s->right[c]] = s->left[c];
+    s->covered[c] = true;
+    for (int i = s->down[c]; i != c; i = s->down[i])
+        for (int j = s->right[i]; j != i; j = s->right[j]) {
+            s->down[s->up[j]] = s->down[j];
+            s->up[s->down[j]] = s->up[j];
+            s->size[s->column[j]]--;
+        }
+}
+
+static void uncover(DlxSolver *s, int c) {
+    for (int i = s->up[c]; i != c; i = s->up[i])
+        for (int j = s->left[i]; j != i; j = s->left[j]) {
+            s->size[s->column[j]]++;
+            s->down[s->up[j]] = (short)j;
+            s->up[s->down[j]] = (short)j;
+        }
+    s->covered[c] = false;
+    s->right[s->left[c]] = (short)c;
+    s->left[s->right[c]] = (short)c;
+}
+
+static void search(DlxSolver *s) {
+    if (s->right[ROOT] == ROOT) {
+        if (s->found == 0 && s->first)
+            for (int i = 0; i < s->depth; i++) {
+                int row = (s->path[i] - 1 - DLX_COLS) / 4; // cell * 9 + val - 1
+                s->first[row / 9] = (u8)(row % 9 + 1);
+            }
+        s->found++;
+        return;
+    }
+
+    // Column with the fewest remaining rows
+    int best = s->right[ROOT];
+    for (int c = s->right[best]; c != ROOT && s->size[best] > 1; c = s->right[c])
+        if (s->size[c] < s->size[best]) best = c;
+    if (s->size[best] == 0) return;
+
+    cover(s, best);
+    for (int r = s->down[best]; r != best && s->found < s->limit; r = s->down[r]) {
+        for (int j = s->right[r]; j != r; j = s->right[j]) cover(s, s->column[j]);
+        s->path[s->depth++] = (short)r;
+        search(s);
+        s->depth--;
+        for (int j = s->left[r]; j != r; j = s->left[j]) uncover(s, s->column[j]);
+    }
+    uncover(s, best);
+}
+
+int dlx_count_solutions(DlxSolver *s, const u8 grid[CELLS], int limit) {
+    return dlx_solve(s, grid, limit, NULL);
+}
+
+int dlx_solve(DlxSolver *s, const u8 grid[CELLS], int limit, u8 solution[CELLS]) {
+    short placed[CELLS];
+    int nplaced = 0;
+    bool ok = true;
+
+    // Select the given rows by covering their four columns
+    for (int cell = 0; cell < CELLS && ok; cell++) {
+        if (grid[cell] == 0) continue;
+        if (grid[cell] > 9) { ok = false; break; }
+        int first = row_node(cell, grid[cell]);
+        for (int k = 0; k < 4; k++)
+            if (s->covered[s->column[first + k]]) ok = false;
+        if (!ok) break;
+        for (int k = 0; k < 4; k++) cover(s, s->column[first + k]);
+        placed[nplaced++] = (short)first;
+    }
+
+    s->limit = limit > 0 ? limit : INT_MAX;
+    s->found = 0;
+    s->depth = 0;
+    // Givens first; the search fills in the rest on the first solution
+    u8 known[CELLS];
+    memcpy(known, grid, CELLS);
+    s->first = solution ? known : NULL;
+    if (ok) search(s);
+    if (solution && s->found > 0) memcpy(solution, known, CELLS);
+    s->first = NULL;
+
+    // Restore the full matrix in reverse order
+    while (nplaced > 0) {
+        int first = placed[--nplaced];
+        for (int k = 3; k >= 0; k--) uncover(s, s->column[first + k]);
+    }
+    return s->found;
+}
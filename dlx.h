@@ -0,0 +1,42 @@
+#ifndef DLX_H
+#define DLX_H
+
+#include "sudoku.h"
+
+// Exact-cover columns: cell filled, row-digit, column-digit, box-digit
+#define DLX_COLS  (4 * CELLS)
+// One candidate row per (cell, digit)
+#define DLX_ROWS  (CELLS * 9)
+#define DLX_NODES (1 + DLX_COLS + DLX_ROWS * 4)
+
+// Dancing Links solver over a preallocated node pool. The full matrix is
+// built once by dlx_init(); each solve covers the givens, searches and
+// uncovers again, so no allocation happens per call. It is a standalone
+// backend: count_solutions() and the generators do not use it, so the
+// game builds without it.
+typedef struct {
+    short left[DLX_NODES];
+    short right[DLX_NODES];
+    short up[DLX_NODES];
+    short down[DLX_NODES];
+    short column[DLX_NODES];
+    short size[DLX_COLS + 1];
+    bool covered[DLX_COLS + 1];
+    short path[CELLS]; // rows chosen on the current search path
+    int depth;
+    u8 *first;         // receives the first solution, or NULL
+    int limit;
+    int found;
+} DlxSolver;
+
+void dlx_init(DlxSolver *s);
+// Same contract as count_solutions(), but stops once limit solutions are
+// found; limit <= 0 counts every solution. Conflicting givens count as 0
+// solutions. grid is not modified.
+int dlx_count_solutions(DlxSolver *s, const u8 grid[CELLS], int limit);
+// dlx_count_solutions() that also writes the first solution found to
+// solution (left untouched when there is none). The solve CLI selects it
+// with -x.
+int dlx_solve(DlxSolver *s, const u8 grid[CELLS], int limit, u8 solution[CELLS]);
+
+#endif // DLX_H
@@ -1,4 +1,5 @@
 #include "gui.h"
+#include "pool.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
@@ -16,6 +17,9 @@ Color GIVEN_NUM_COLOR          = {0, 0, 0, 255};
 Color USER_NUM_COLOR           = {44, 53, 54, 255};
 
 NumberButton numberButtons[NUM_COUNT];
+Board board;
+int pendingHoles = 0;
+static int missedHoles = 0; // pendingHoles of a request the pool already missed
 
 bool flashError = false;
 int flashFrames = 0;
@@ -51,7 +55,7 @@ Clay_RenderCommandArray CreateGridLayout(void) {
                 }) {
                     for (int c = 0; c < 9; c++) {
                         int cellIndex = idx(r, c);
-                        Clay_Color bg = (initial_grid[cellIndex] != 0) ? STATIC_CELL_COLOR : EDITABLE_CELL_COLOR;
+                        Clay_Color bg = (board.givens[cellIndex] != 0) ? STATIC_CELL_COLOR : EDITABLE_CELL_COLOR;
                         CLAY_AUTO_ID({
                             .layout = {
                                 .sizing = {.width = CLAY_SIZING_FIXED(cellSize),
@@ -108,11 +112,30 @@ Clay_RenderCommandArray CreateMenuLayout(void) {
 
 
 void render_game_loop(Clay_Arena arena, int fontSize) {
-
+    board_init(&board);
+    board_seed(&board, (u64)time(NULL));
+    PuzzlePool *pool = puzzle_pool_create(PUZZLE_POOL_DEPTH, rng_next(&board.rng));
 
     while (!WindowShouldClose()) {
         Vector2 mouse = GetMousePosition();
 
+        // Start a requested game once the pool has a puzzle for it
+        if (pool) puzzle_pool_tick(pool, GENERATE_BUDGET_US);
+        if (pendingHoles != 0) {
+            bool ready = true;
+            if (pool && missedHoles == pendingHoles) ready = puzzle_pool_poll(pool, pendingHoles, &board);
+            else if (pool) ready = puzzle_pool_take(pool, pendingHoles, &board);
+            else make_puzzle(&board, pendingHoles);
+            missedHoles = ready ? 0 : pendingHoles;
+            if (ready) {
+                pendingHoles = 0;
+                activeCellIndex = -1;
+                flashError = false;
+                flashFrames = 0;
+                gameState = GAME_PLAY;
+            }
+        }
+
         //MENU
         if (gameState == GAME_MENU) {
             hoveredDifficulty = -1;
@@ -148,17 +171,12 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
 
             // Handle button click
             if (clickedIndex != -1) {
-                if (clickedIndex == 0) difficultyHoles = EASY_HOLES;
-                else if (clickedIndex == 1) difficultyHoles = MEDIUM_HOLES;
-                else difficultyHoles = HARD_HOLES;
+                int holes;
+                if (clickedIndex == 0) holes = EASY_HOLES;
+                else if (clickedIndex == 1) holes = MEDIUM_HOLES;
+                else holes = HARD_HOLES;
 
-                make_puzzle(grid, initial_grid, difficultyHoles);
-                activeCellIndex = -1;
-                flashError = false;
-                flashFrames = 0;
-                mistakes = 0;
-                showSolution = false;
-                gameState = GAME_PLAY;
+                pendingHoles = holes;
             }
 
             //Draw Menu
@@ -181,6 +199,10 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
                     btnRects[b].y + (btnRects[b].height - textSize)/2+22.0f,
                     24, BLACK);
             }
+            if (pendingHoles != 0) {
+                int pct = pool ? (int)(puzzle_pool_progress(pool, pendingHoles) * 100) : 0;
+                DrawText(TextFormat("Generating... %d%%", pct), GetScreenWidth()/2 - 80, GetScreenHeight() - 80, 20, GRAY);
+            }
 
             EndDrawing();
             continue;
@@ -190,7 +212,7 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
         Clay_RenderCommandArray gridCommands = CreateGridLayout();
 
         // Active cell selection
-        if (!showSolution && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        if (!board.show_solution && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
             activeCellIndex = -1;
             flashError = false;
             flashFrames = 0;
@@ -208,22 +230,22 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
         }
 
         // Input handling
-        if (!showSolution && activeCellIndex != -1 && initial_grid[activeCellIndex] == 0 && !gameComplete) {
+        if (!board.show_solution && activeCellIndex != -1 && board.givens[activeCellIndex] == 0 && !board.complete) {
             int key = GetKeyPressed();
             if (key >= KEY_ONE && key <= KEY_NINE) {
                 u8 val = (u8)(key - KEY_ZERO);
 
-                if (val == solution_grid[activeCellIndex]) {
-                    grid[activeCellIndex] = val;
+                if (val == board.solution[activeCellIndex]) {
+                    board_set(&board, activeCellIndex, val);
                     flashError = false;
                 } else {
                     flashError = true;
                     flashFrames = flashDuration;
-                    mistakes++;
-                    if (mistakes >= 3) showSolution = true;
+                    board.mistakes++;
+                    if (board.mistakes >= MAX_MISTAKES) board.show_solution = true;
                 }
             } else if (key == KEY_BACKSPACE || key == KEY_DELETE) {
-                grid[activeCellIndex] = 0;
+                board_set(&board, activeCellIndex, 0);
                 flashError = false;
             }
         }
@@ -247,15 +269,10 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
             gameState = GAME_MENU;
         }
         if (CheckCollisionPointRec(mouse, showBtn) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            showSolution = true;
+            board.show_solution = true;
         }
         if (CheckCollisionPointRec(mouse, resetBtn) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            make_puzzle(grid, initial_grid, difficultyHoles);
-            activeCellIndex = -1;
-            flashError = false;
-            flashFrames = 0;
-            mistakes = 0;
-            showSolution = false;
+            pendingHoles = board.holes;
         }
 
         //DRAW GAME
@@ -271,7 +288,7 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
             bool hovered = CheckCollisionPointRec(mouse, cellRect);
             Color fillColor;
 
-            if (showSolution) { 
+            if (board.show_solution) { 
                 fillColor = (Color){STATIC_CELL_COLOR.r, STATIC_CELL_COLOR.g, STATIC_CELL_COLOR.b, STATIC_CELL_COLOR.a}; 
             } 
             else if (i == activeCellIndex && flashFrames > 0) { 
@@ -284,18 +301,18 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
                 fillColor = (Color){HOVER_COLOR.r, HOVER_COLOR.g, HOVER_COLOR.b, HOVER_COLOR.a}; 
             } 
             else { 
-                fillColor = (initial_grid[i] != 0) ? (Color){STATIC_CELL_COLOR.r, STATIC_CELL_COLOR.g, STATIC_CELL_COLOR.b, STATIC_CELL_COLOR.a} : (Color){EDITABLE_CELL_COLOR.r, EDITABLE_CELL_COLOR.g, EDITABLE_CELL_COLOR.b, EDITABLE_CELL_COLOR.a}; 
+                fillColor = (board.givens[i] != 0) ? (Color){STATIC_CELL_COLOR.r, STATIC_CELL_COLOR.g, STATIC_CELL_COLOR.b, STATIC_CELL_COLOR.a} : (Color){EDITABLE_CELL_COLOR.r, EDITABLE_CELL_COLOR.g, EDITABLE_CELL_COLOR.b, EDITABLE_CELL_COLOR.a}; 
             }
 
             DrawRectangleRec(cellRect, fillColor);
             DrawRectangleLinesEx(cellRect, 1, BLACK);
 
             // Numbers
-            if (grid[i] != 0 || showSolution) {
+            if (board.values[i] != 0 || board.show_solution) {
                 char label[3];
-                snprintf(label, sizeof(label), "%d", showSolution ? solution_grid[i] : grid[i]);
+                snprintf(label, sizeof(label), "%d", board.show_solution ? board.solution[i] : board.values[i]);
                 int ts = MeasureText(label, fontSize);
-                Color textColor = (initial_grid[i] != 0) ? GIVEN_NUM_COLOR : USER_NUM_COLOR;
+                Color textColor = (board.givens[i] != 0) ? GIVEN_NUM_COLOR : USER_NUM_COLOR;
                 DrawText(label, 
                     cellRect.x + (cellRect.width - ts)/2, cellRect.y + (cellRect.height - ts)/2-3.0f,
                     fontSize, textColor);
@@ -334,20 +351,25 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
 
         // Mistakes counter
         DrawText(
-            TextFormat("Mistakes: %d/%d", mistakes, maxMistakes),
+            TextFormat("Mistakes: %d/%d", board.mistakes, MAX_MISTAKES),
             mistakesPos.x,
             mistakesPos.y,
             16,
             RED
         );
 
-        if (is_complete() && !gameComplete) {
-            gameComplete = true;
-            showSolution = true; 
+        if (is_complete(&board) && !board.complete) {
+            board.complete = true;
+            board.show_solution = true; 
+
+        }
 
+        if (pendingHoles != 0) {
+            int pct = pool ? (int)(puzzle_pool_progress(pool, pendingHoles) * 100) : 0;
+            DrawText(TextFormat("Generating... %d%%", pct), resetBtn.x, resetBtn.y + 40, 16, GRAY);
         }
 
-        if (gameComplete) {
+        if (board.complete) {
 
             DrawText(
                 "Sudoku \n Complete! 🎉",
@@ -363,5 +385,6 @@ void render_game_loop(Clay_Arena arena, int fontSize) {
 
         EndDrawing();
     }
+    puzzle_pool_destroy(pool);
 }
 
@@ -5,6 +5,8 @@
 #include "clay.h"
 #include "raylib.h"
 #define NUM_COUNT 9
+#define PUZZLE_POOL_DEPTH 4 // ready puzzles kept per difficulty
+#define GENERATE_BUDGET_US 4000 // per-frame generation time without threads, keeps 60 FPS
 
 typedef enum { GAME_MENU, GAME_PLAY } GameState;
 typedef struct {
@@ -26,6 +28,8 @@ extern Color GIVEN_NUM_COLOR;
 extern Color USER_NUM_COLOR;
 
 extern NumberButton numberButtons[NUM_COUNT];
+extern Board board;
+extern int pendingHoles; // difficulty waiting for a pooled puzzle, 0 if none
 
 Clay_RenderCommandArray CreateGridLayout(void);
 Clay_RenderCommandArray CreateMenuLayout(void);
@@ -0,0 +1,271 @@
+#define _POSIX_C_SOURCE 199309L
+#include "pool.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define POOL_THREADED 0
+#else
+#define POOL_THREADED 1
+#include <pthread.h>
+#endif
+
+#define POOL_SLICE_US 5000 // worker slice, bounds how long shutdown waits
+
+static const int level_holes[POOL_LEVELS] = {EASY_HOLES, MEDIUM_HOLES, HARD_HOLES};
+
+typedef struct {
+    u64 seed;
+    u8 givens[CELLS];
+    u8 solution[CELLS];
+} PoolEntry;
+
+typedef struct {
+    PoolEntry *entries; // depth slots, oldest at head
+    int head;
+    int count;
+    long hits, misses, refills;
+    double total_ms, max_ms;
+    long techniques[TECH_COUNT]; // refills by hardest technique needed
+} PoolRing;
+
+struct PuzzlePool {
+    int depth;
+    PoolRing rings[POOL_LEVELS];
+    PoolEntry *storage;
+    // Generator state, only touched by the refilling side
+    PuzzleJob *job;
+    Rng seeds;
+    Board work;
+    double job_ms;  // time spent in the current job's slices
+    int job_level;  // level being generated, -1 if idle; written under the lock
+    float progress; // of the current job, published under the lock
+    int wanted;     // level that last missed, refilled first; -1 if none
+    bool shutdown;
+#if POOL_THREADED
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t refill;
+#endif
+};
+
+#if POOL_THREADED
+static void pool_lock(PuzzlePool *pool) { pthread_mutex_lock(&pool->lock); }
+static void pool_unlock(PuzzlePool *pool) { pthread_mutex_unlock(&pool->lock); }
+static void pool_wake(PuzzlePool *pool) { pthread_cond_signal(&pool->refill); }
+#else
+static void pool_lock(PuzzlePool *pool) { (void)pool; }
+static void pool_unlock(PuzzlePool *pool) { (void)pool; }
+static void pool_wake(PuzzlePool *pool) { (void)pool; }
+#endif
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int level_of(int holes) {
+    for (int l = 0; l < POOL_LEVELS; l++)
+        if (level_holes[l] == holes) return l;
+    return -1;
+}
+
+// Level to generate next (caller holds the lock): the one that last missed,
+// else the emptiest ring below depth; -1 when every ring is full
+static int next_level(const PuzzlePool *pool) {
+    if (pool->wanted >= 0 && pool->rings[pool->wanted].count < pool->depth) return pool->wanted;
+    int best = -1;
+    for (int l = 0; l < POOL_LEVELS; l++) {
+        int n = pool->rings[l].count;
+        if (n < pool->depth && (best < 0 || n < pool->rings[best].count)) best = l;
+    }
+    return best;
+}
+
+// Advance the refill job by one slice of at most budget_us, starting a new
+// puzzle if idle and queueing it once done; false if every ring is full
+static bool refill(PuzzlePool *pool, long budget_us) {
+    if (pool->job_level < 0) {
+        pool_lock(pool);
+        int level = next_level(pool);
+        pool->job_level = level;
+        pool_unlock(pool);
+        if (level < 0) return false;
+        puzzle_job_start(pool->job, rng_next(&pool->seeds), level_holes[level]);
+        pool->job_ms = 0.0;
+    }
+
+    double t0 = now_ms();
+    bool done = puzzle_job_step(pool->job, budget_us);
+    pool->job_ms += now_ms() - t0;
+    if (!done) {
+        pool_lock(pool);
+        pool->progress = puzzle_job_progress(pool->job);
+        pool_unlock(pool);
+        return true;
+    }
+
+    // Grade the puzzle before it is queued, outside the lock. Rating is not
+    // sliced: a HARD puzzle takes about 0.2 ms, a quarter of generating it
+    int level = pool->job_level;
+    puzzle_job_load(pool->job, &pool->work);
+    t0 = now_ms();
+    Rating rating;
+    rate_puzzle(pool->work.givens, TECH_TRIAL, &rating);
+    double dt = pool->job_ms + (now_ms() - t0);
+
+    pool_lock(pool);
+    pool->job_level = -1;
+    pool->progress = 0.0f;
+    PoolRing *ring = &pool->rings[level];
+    PoolEntry *e = &ring->entries[(ring->head + ring->count) % pool->depth];
+    e->seed = pool->work.seed;
+    memcpy(e->givens, pool->work.givens, CELLS);
+    memcpy(e->solution, pool->work.solution, CELLS);
+    ring->count++;
+    ring->techniques[rating.hardest]++;
+    ring->refills++;
+    ring->total_ms += dt;
+    if (dt > ring->max_ms) ring->max_ms = dt;
+    if (pool->wanted == level) pool->wanted = -1;
+    pool_unlock(pool);
+    return true;
+}
+
+#if POOL_THREADED
+static void *worker_main(void *p) {
+    PuzzlePool *pool = p;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->job_level < 0 && next_level(pool) < 0)
+            pthread_cond_wait(&pool->refill, &pool->lock);
+        if (pool->shutdown) break;
+        pthread_mutex_unlock(&pool->lock);
+        refill(pool, POOL_SLICE_US);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+#endif
+
+PuzzlePool *puzzle_pool_create(int depth, u64 seed) {
+    if (depth <= 0) return NULL;
+    PuzzlePool *pool = calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+    pool->storage = calloc((size_t)depth * POOL_LEVELS, sizeof(PoolEntry));
+    if (!pool->storage) {
+        free(pool);
+        return NULL;
+    }
+    pool->job = puzzle_job_create(&searchDefaults);
+    if (!pool->job) {
+        free(pool->storage);
+        free(pool);
+        return NULL;
+    }
+    pool->depth = depth;
+    pool->wanted = -1;
+    pool->job_level = -1;
+    for (int l = 0; l < POOL_LEVELS; l++) pool->rings[l].entries = pool->storage + (size_t)l * depth;
+    rng_seed(&pool->seeds, seed);
+    board_init(&pool->work);
+
+#if POOL_THREADED
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->refill, NULL);
+    if (pthread_create(&pool->worker, NULL, worker_main, pool) != 0) {
+        pthread_mutex_destroy(&pool->lock);
+        pthread_cond_destroy(&pool->refill);
+        puzzle_job_destroy(pool->job);
+        free(pool->storage);
+        free(pool);
+        return NULL;
+    }
+#endif
+    return pool;
+}
+
+void puzzle_pool_destroy(PuzzlePool *pool) {
+    if (!pool) return;
+#if POOL_THREADED
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_signal(&pool->refill);
+    pthread_mutex_unlock(&pool->lock);
+    pthread_join(pool->worker, NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->refill);
+#endif
+    puzzle_job_destroy(pool->job);
+    free(pool->storage);
+    free(pool);
+}
+
+// Pop the oldest puzzle for holes into b. A miss always moves the level to
+// the front of the refill order; count says whether this call is a new game
+// request for the hit/miss statistics or a retry of one already counted.
+static bool take(PuzzlePool *pool, int holes, Board *b, bool count) {
+    int level = level_of(holes);
+    if (level < 0) return false;
+
+    PoolEntry e;
+    pool_lock(pool);
+    PoolRing *ring = &pool->rings[level];
+    bool hit = ring->count > 0;
+    if (hit) {
+        e = ring->entries[ring->head];
+        ring->head = (ring->head + 1) % pool->depth;
+        ring->count--;
+        if (count) ring->hits++;
+    } else {
+        if (count) ring->misses++;
+        pool->wanted = level;
+    }
+    pool_wake(pool);
+    pool_unlock(pool);
+
+    if (hit) board_load(b, e.givens, e.solution, e.seed, holes);
+    return hit;
+}
+
+bool puzzle_pool_take(PuzzlePool *pool, int holes, Board *b) {
+    return take(pool, holes, b, true);
+}
+
+bool puzzle_pool_poll(PuzzlePool *pool, int holes, Board *b) {
+    return take(pool, holes, b, false);
+}
+
+bool puzzle_pool_tick(PuzzlePool *pool, long budget_us) {
+#if POOL_THREADED
+    (void)pool;
+    (void)budget_us;
+    return false;
+#else
+    return refill(pool, budget_us);
+#endif
+}
+
+float puzzle_pool_progress(PuzzlePool *pool, int holes) {
+    int level = level_of(holes);
+    pool_lock(pool);
+    float p = (level >= 0 && pool->job_level == level) ? pool->progress : 0.0f;
+    pool_unlock(pool);
+    return p;
+}
+
+void puzzle_pool_stats(PuzzlePool *pool, int level, PoolStats *out) {
+    pool_lock(pool);
+    const PoolRing *ring = &pool->rings[level];
+    out->hits = ring->hits;
+    out->misses = ring->misses;
+    out->refills = ring->refills;
+    out->refill_ms = ring->refills ? ring->total_ms / ring->refills : 0.0;
+    out->refill_max_ms = ring->max_ms;
+    out->ready = ring->count;
+    memcpy(out->techniques, ring->techniques, sizeof(out->techniques));
+    pool_unlock(pool);
+}
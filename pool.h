@@ -0,0 +1,54 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "rate.h"
+#include "sudoku.h"
+
+// Ready-made puzzles for EASY_HOLES, MEDIUM_HOLES and HARD_HOLES, each in a
+// ring buffer kept topped up to a fixed depth. With pthreads a background
+// worker refills the rings; in single-threaded WASM builds the render loop
+// refills them one time slice per frame through puzzle_pool_tick().
+// Every generated puzzle is graded with rate_puzzle() before it is queued,
+// so builds with pool.c also need rate.c:
+//   cc ... pool.c rate.c sudoku.c candidates.c
+typedef struct PuzzlePool PuzzlePool;
+
+#define POOL_LEVELS 3
+
+typedef struct {
+    long hits;          // puzzle_pool_take() calls served from the ring
+    long misses;        // puzzle_pool_take() calls that found the ring empty
+    long refills;       // puzzles generated into the ring
+    double refill_ms;   // mean generation time per refill
+    double refill_max_ms;
+    int ready;          // puzzles currently queued
+    long techniques[TECH_COUNT]; // refills by the hardest technique they need
+} PoolStats;
+
+// depth puzzles per level; the worker generates with a copy of
+// searchDefaults and seeds drawn from seed. Returns NULL on failure.
+PuzzlePool *puzzle_pool_create(int depth, u64 seed);
+void puzzle_pool_destroy(PuzzlePool *pool);
+
+// Start a game on b from the ring for holes. Never generates: on a miss it
+// returns false, moves that level to the front of the refill order and the
+// caller retries with puzzle_pool_poll() on a later frame. Call it once per
+// game request: each call counts as one hit or one miss.
+bool puzzle_pool_take(PuzzlePool *pool, int holes, Board *b);
+
+// puzzle_pool_take() for a request that already missed: the same take and
+// refill priority, but left out of the hit/miss counts
+bool puzzle_pool_poll(PuzzlePool *pool, int holes, Board *b);
+
+// Spend up to about budget_us generating for the emptiest ring, resuming
+// where the last tick stopped. Only does work in builds without threads;
+// returns false when there was nothing to do.
+bool puzzle_pool_tick(PuzzlePool *pool, long budget_us);
+
+// Progress 0..1 of the puzzle being generated for holes, 0 if none is
+float puzzle_pool_progress(PuzzlePool *pool, int holes);
+
+// Level is 0..POOL_LEVELS-1 for EASY, MEDIUM, HARD
+void puzzle_pool_stats(PuzzlePool *pool, int level, PoolStats *out);
+
+#endif // POOL_H
@@ -0,0 +1,541 @@
+#include "rate.h"
+#include <string.h>
+
+const char *const technique_names[TECH_COUNT] = {
+    "none", "hidden single", "naked single", "locked candidates", "pair", "triple",
+    "quad", "x-wing", "swordfish", "chain", "trial",
+};
+
+// Score per productive step
+static const int technique_weight[TECH_COUNT] = {0, 1, 2, 4, 6, 8, 10, 12, 14, 20, 0};
+
+// 81 cells as bits: 0-63 in w[0], 64-80 in w[1]
+typedef struct {
+    u64 w[2];
+} Bits;
+
+// Rows 0-8, columns 9-17, boxes 18-26
+static const Bits unit_bits[27] = {
+    {{0x00000000000001ffull, 0x00000ull}},
+    {{0x000000000003fe00ull, 0x00000ull}},
+    {{0x0000000007fc0000ull, 0x00000ull}},
+    {{0x0000000ff8000000ull, 0x00000ull}},
+    {{0x00001ff000000000ull, 0x00000ull}},
+    {{0x003fe00000000000ull, 0x00000ull}},
+    {{0x7fc0000000000000ull, 0x00000ull}},
+    {{0x8000000000000000ull, 0x000ffull}},
+    {{0x0000000000000000ull, 0x1ff00ull}},
+    {{0x8040201008040201ull, 0x00100ull}},
+    {{0x0080402010080402ull, 0x00201ull}},
+    {{0x0100804020100804ull, 0x00402ull}},
+    {{0x0201008040201008ull, 0x00804ull}},
+    {{0x0402010080402010ull, 0x01008ull}},
+    {{0x0804020100804020ull, 0x02010ull}},
+    {{0x1008040201008040ull, 0x04020ull}},
+    {{0x2010080402010080ull, 0x08040ull}},
+    {{0x4020100804020100ull, 0x10080ull}},
+    {{0x00000000001c0e07ull, 0x00000ull}},
+    {{0x0000000000e07038ull, 0x00000ull}},
+    {{0x00000000070381c0ull, 0x00000ull}},
+    {{0x0000e07038000000ull, 0x00000ull}},
+    {{0x00070381c0000000ull, 0x00000ull}},
+    {{0x00381c0e00000000ull, 0x00000ull}},
+    {{0x81c0000000000000ull, 0x00703ull}},
+    {{0x0e00000000000000ull, 0x0381cull}},
+    {{0x7000000000000000ull, 0x1c0e0ull}},
+};
+
+static inline Bits b_and(Bits a, Bits b) {
+    return (Bits){{a.w[0] & b.w[0], a.w[1] & b.w[1]}};
+}
+
+static inline Bits b_or(Bits a, Bits b) {
+    return (Bits){{a.w[0] | b.w[0], a.w[1] | b.w[1]}};
+}
+
+static inline Bits b_andnot(Bits a, Bits b) {
+    return (Bits){{a.w[0] & ~b.w[0], a.w[1] & ~b.w[1]}};
+}
+
+static inline bool b_any(Bits a) {
+    return (a.w[0] | a.w[1]) != 0;
+}
+
+static inline int b_count(Bits a) {
+    return __builtin_popcountll(a.w[0]) + __builtin_popcountll(a.w[1]);
+}
+
+// Lowest cell of a non-empty set
+static inline int b_first(Bits a) {
+    return a.w[0] ? __builtin_ctzll(a.w[0]) : 64 + __builtin_ctzll(a.w[1]);
+}
+
+static inline Bits b_cell(int cell) {
+    return cell < 64 ? (Bits){{1ull << cell, 0}} : (Bits){{0, 1ull << (cell - 64)}};
+}
+
+static inline bool b_has(Bits a, int cell) {
+    return cell < 64 ? (a.w[0] >> cell) & 1 : (a.w[1] >> (cell - 64)) & 1;
+}
+
+// Cells sharing a unit with cell, cell itself excluded
+static inline Bits peers(int cell) {
+    int r = cell / 9, c = cell % 9;
+    Bits p = b_or(b_or(unit_bits[r], unit_bits[9 + c]), unit_bits[18 + box_of(r, c)]);
+    return b_andnot(p, b_cell(cell));
+}
+
+// The 9 bits of row r as a column mask
+static inline u16 row_mask(Bits a, int r) {
+    int s = r * 9;
+    u64 v = s >= 64 ? a.w[1] >> (s - 64) : (a.w[0] >> s) | (s > 55 ? a.w[1] << (64 - s) : 0);
+    return (u16)(v & 0x1FF);
+}
+
+typedef struct {
+    u8 grid[CELLS];
+    Bits cand[9];   // cells where digit d + 1 may still go
+    Bits placed[9]; // cells holding digit d + 1
+    Bits empty;
+} RateState;
+
+// Place d + 1 on cell; false if it is no longer a candidate there
+static bool place(RateState *s, int cell, int d) {
+    if (!b_has(s->cand[d], cell)) return false;
+    Bits one = b_cell(cell);
+    s->grid[cell] = (u8)(d + 1);
+    s->empty = b_andnot(s->empty, one);
+    s->placed[d] = b_or(s->placed[d], one);
+    for (int k = 0; k < 9; k++) s->cand[k] = b_andnot(s->cand[k], one);
+    s->cand[d] = b_andnot(s->cand[d], peers(cell));
+    return true;
+}
+
+// Remove d + 1 from cells; true if any had it
+static bool eliminate(RateState *s, int d, Bits cells) {
+    Bits hit = b_and(s->cand[d], cells);
+    if (!b_any(hit)) return false;
+    s->cand[d] = b_andnot(s->cand[d], hit);
+    return true;
+}
+
+// Candidate counts per cell, bit-sliced: cells with at least one, two and
+// three candidates
+static void count_planes(const RateState *s, Bits *ones, Bits *twos, Bits *threes) {
+    Bits o = {{0, 0}}, t = {{0, 0}}, h = {{0, 0}};
+    for (int d = 0; d < 9; d++) {
+        h = b_or(h, b_and(t, s->cand[d]));
+        t = b_or(t, b_and(o, s->cand[d]));
+        o = b_or(o, s->cand[d]);
+    }
+    *ones = o;
+    *twos = t;
+    if (threes) *threes = h;
+}
+
+static u16 cell_digits(const RateState *s, int cell) {
+    u16 m = 0;
+    for (int d = 0; d < 9; d++)
+        if (b_has(s->cand[d], cell)) m |= (u16)(1u << d);
+    return m;
+}
+
+//
+// Techniques: each makes one full pass and returns how many times it made
+// progress, or -1 on a contradiction
+//
+
+static int hidden_singles(RateState *s) {
+    int n = 0;
+    for (int u = 0; u < 27; u++)
+        for (int d = 0; d < 9; d++) {
+            if (b_any(b_and(s->placed[d], unit_bits[u]))) continue;
+            Bits m = b_and(s->cand[d], unit_bits[u]);
+            int k = b_count(m);
+            if (k == 0) return -1;
+            if (k == 1) {
+                if (!place(s, b_first(m), d)) return -1;
+                n++;
+            }
+        }
+    return n;
+}
+
+static int naked_singles(RateState *s) {
+    Bits ones, twos;
+    count_planes(s, &ones, &twos, NULL);
+    if (b_any(b_andnot(s->empty, ones))) return -1;
+    Bits singles = b_andnot(b_and(s->empty, ones), twos);
+    int n = 0;
+    while (b_any(singles)) {
+        int cell = b_first(singles);
+        singles = b_andnot(singles, b_cell(cell));
+        u16 m = cell_digits(s, cell);
+        if (m == 0) return -1; // emptied by a single placed this pass
+        if (!place(s, cell, __builtin_ctz(m))) return -1;
+        n++;
+    }
+    return n;
+}
+
+// A digit confined to one line within a box leaves the rest of the line
+// (pointing); confined to one box within a line, it leaves the rest of the
+// box (claiming)
+static int locked_candidates(RateState *s) {
+    int n = 0;
+    for (int d = 0; d < 9; d++)
+        for (int b = 0; b < 9; b++) {
+            Bits box = unit_bits[18 + b];
+            for (int k = 0; k < 3; k++) {
+                const Bits *lines[2] = {&unit_bits[(b / 3) * 3 + k], &unit_bits[9 + (b % 3) * 3 + k]};
+                for (int l = 0; l < 2; l++) {
+                    Bits line = *lines[l];
+                    Bits in_box = b_and(s->cand[d], box), in_line = b_and(s->cand[d], line);
+                    if (b_any(in_box) && !b_any(b_andnot(in_box, line)))
+                        n += eliminate(s, d, b_andnot(line, box));
+                    if (b_any(in_line) && !b_any(b_andnot(in_line, box)))
+                        n += eliminate(s, d, b_andnot(box, line));
+                }
+            }
+        }
+    return n;
+}
+
+// Next larger mask with the same number of bits set
+static inline u16 next_combination(u16 set) {
+    u16 low = set & (u16)-set, up = (u16)(set + low);
+    return (u16)((((up ^ set) >> 2) / low) | up);
+}
+
+// Naked and hidden subsets of size k in every unit. Each unit is worked on
+// as 9-bit masks: the digits open in each of its cells and the cells open
+// for each digit.
+static int subsets(RateState *s, int k) {
+    u16 digits[CELLS];
+    for (int i = 0; i < CELLS; i++) digits[i] = 0;
+    for (int d = 0; d < 9; d++)
+        for (Bits m = s->cand[d]; b_any(m);) {
+            int cell = b_first(m);
+            m = b_andnot(m, b_cell(cell));
+            digits[cell] |= (u16)(1u << d);
+        }
+
+    int n = 0;
+    for (int u = 0; u < 27; u++) {
+        u16 cell_digs[9], digit_cells[9] = {0}, open = 0;
+        for (int p = 0; p < 9; p++) {
+            cell_digs[p] = digits[unit_cell(u, p)];
+            if (cell_digs[p]) open |= (u16)(1u << p);
+            for (u16 m = cell_digs[p]; m; m &= m - 1) digit_cells[__builtin_ctz(m)] |= (u16)(1u << p);
+        }
+        if (__builtin_popcount(open) <= k) continue;
+        u16 present = 0;
+        for (int d = 0; d < 9; d++)
+            if (digit_cells[d]) present |= (u16)(1u << d);
+
+        for (u16 set = (u16)((1u << k) - 1); set < 0x200; set = next_combination(set)) {
+            if (set & ~present) continue;
+            // Naked: k cells whose candidates all lie in set
+            u16 cells = 0, where = 0;
+            for (int p = 0; p < 9; p++)
+                if (cell_digs[p] && !(cell_digs[p] & ~set)) cells |= (u16)(1u << p);
+            for (u16 m = set; m; m &= m - 1) where |= digit_cells[__builtin_ctz(m)];
+            u16 clear_cells = 0, clear_digits = 0;
+            if (__builtin_popcount(cells) == k) {
+                clear_cells = open & ~cells;
+                clear_digits = set;
+            } else if (__builtin_popcount(where) == k) {
+                // Hidden: the k digits fit in only k cells
+                clear_cells = where;
+                clear_digits = (u16)(0x1FF & ~set);
+            }
+
+            bool hit = false;
+            for (u16 m = clear_cells; m; m &= m - 1) {
+                int p = __builtin_ctz(m), cell = unit_cell(u, p);
+                u16 gone = cell_digs[p] & clear_digits;
+                if (!gone) continue;
+                hit = true;
+                cell_digs[p] &= (u16)~gone;
+                digits[cell] &= (u16)~gone;
+                for (u16 g = gone; g; g &= g - 1) {
+                    int d = __builtin_ctz(g);
+                    digit_cells[d] &= (u16)~(1u << p);
+                    eliminate(s, d, b_cell(cell));
+                }
+            }
+            n += hit;
+        }
+    }
+    return n;
+}
+
+static int pairs(RateState *s) {
+    return subsets(s, 2);
+}
+
+static int triples(RateState *s) {
+    return subsets(s, 3);
+}
+
+static int quads(RateState *s) {
+    return subsets(s, 4);
+}
+
+// Size-k fish: k base rows (or columns) whose candidates for a digit lie
+// in k columns (rows) clear the digit from the rest of those lines
+static int fish(RateState *s, int k) {
+    int n = 0;
+    for (int d = 0; d < 9; d++)
+        for (int orient = 0; orient < 2; orient++) {
+            u16 lines[9];
+            for (int r = 0; r < 9; r++) lines[r] = row_mask(s->cand[d], r);
+            if (orient) {
+                u16 cols[9] = {0};
+                for (int r = 0; r < 9; r++)
+                    for (int c = 0; c < 9; c++)
+                        if (lines[r] & (1u << c)) cols[c] |= (u16)(1u << r);
+                memcpy(lines, cols, sizeof(lines));
+            }
+            // Base lines hold the digit in 2..k places
+            u16 usable = 0;
+            for (int r = 0; r < 9; r++) {
+                int c = __builtin_popcount(lines[r]);
+                if (c >= 2 && c <= k) usable |= (u16)(1u << r);
+            }
+            if (__builtin_popcount(usable) < k) continue;
+            for (u16 base = (u16)((1u << k) - 1); base < 0x200; base = next_combination(base)) {
+                if (base & ~usable) continue;
+                u16 cover = 0;
+                for (u16 m = base; m; m &= m - 1) cover |= lines[__builtin_ctz(m)];
+                if (__builtin_popcount(cover) != k) continue;
+
+                Bits base_cells = {{0, 0}}, cover_cells = {{0, 0}};
+                for (int i = 0; i < 9; i++) {
+                    if (base & (1u << i)) base_cells = b_or(base_cells, unit_bits[orient * 9 + i]);
+                    if (cover & (1u << i)) cover_cells = b_or(cover_cells, unit_bits[(1 - orient) * 9 + i]);
+                }
+                n += eliminate(s, d, b_andnot(cover_cells, base_cells));
+            }
+        }
+    return n;
+}
+
+static int xwings(RateState *s) {
+    return fish(s, 2);
+}
+
+static int swordfish(RateState *s) {
+    return fish(s, 3);
+}
+
+// Simple colouring: cells joined by conjugate pairs (the only two places
+// for a digit in a unit) alternate true and false. Two cells of one colour
+// in a unit make that colour false; a cell seeing both colours loses the
+// digit.
+static int colouring(RateState *s) {
+    int n = 0;
+    for (int d = 0; d < 9; d++) {
+        Bits linked = {{0, 0}};
+        u8 link_a[27], link_b[27];
+        int links = 0;
+        for (int u = 0; u < 27; u++) {
+            Bits m = b_and(s->cand[d], unit_bits[u]);
+            if (b_count(m) != 2) continue;
+            link_a[links] = (u8)b_first(m);
+            link_b[links] = (u8)b_first(b_andnot(m, b_cell(link_a[links])));
+            links++;
+            linked = b_or(linked, m);
+        }
+
+        while (b_any(linked)) {
+            // Colour one cluster by flooding across the links
+            Bits colour[2] = {b_cell(b_first(linked)), {{0, 0}}};
+            for (bool grew = true; grew;) {
+                grew = false;
+                for (int i = 0; i < links; i++)
+                    for (int c = 0; c < 2; c++) {
+                        int from = c ? link_b[i] : link_a[i], to = c ? link_a[i] : link_b[i];
+                        for (int k = 0; k < 2; k++)
+                            if (b_has(colour[k], from) && !b_has(colour[1 - k], to)) {
+                                colour[1 - k] = b_or(colour[1 - k], b_cell(to));
+                                grew = true;
+                            }
+                    }
+            }
+            Bits cluster = b_or(colour[0], colour[1]);
+            linked = b_andnot(linked, cluster);
+            if (b_count(cluster) < 3) continue;
+
+            bool hit = false;
+            for (int k = 0; k < 2; k++)
+                for (int u = 0; u < 27; u++)
+                    if (b_count(b_and(colour[k], unit_bits[u])) > 1) {
+                        hit |= eliminate(s, d, colour[k]);
+                        break;
+                    }
+            if (!hit) {
+                Bits sees[2] = {{{0, 0}}, {{0, 0}}};
+                for (int k = 0; k < 2; k++)
+                    for (Bits m = colour[k]; b_any(m);) {
+                        int cell = b_first(m);
+                        m = b_andnot(m, b_cell(cell));
+                        sees[k] = b_or(sees[k], peers(cell));
+                    }
+                hit = eliminate(s, d, b_andnot(b_and(sees[0], sees[1]), cluster));
+            }
+            n += hit;
+        }
+    }
+    return n;
+}
+
+// XY-chains: from a bivalue cell {a, b}, assume it is not a and follow
+// bivalue cells through the digit each one is forced to. A cell forced to
+// a means a is in one of the two ends, so cells seeing both lose a.
+static int xy_chains(RateState *s) {
+    Bits ones, twos, threes;
+    count_planes(s, &ones, &twos, &threes);
+    Bits bivalue = b_andnot(b_and(s->empty, twos), threes);
+    if (b_count(bivalue) < 3) return 0;
+
+    u8 cells[CELLS];
+    u16 digits[CELLS];
+    int nb = 0;
+    for (Bits m = bivalue; b_any(m);) {
+        int cell = b_first(m);
+        m = b_andnot(m, b_cell(cell));
+        digits[nb] = cell_digits(s, cell);
+        cells[nb++] = (u8)cell;
+    }
+
+    int n = 0;
+    for (int i = 0; i < nb; i++)
+        for (u16 pick = digits[i]; pick; pick &= pick - 1) {
+            int a = __builtin_ctz(pick);
+            Bits start_peers = peers(cells[i]);
+            // Breadth-first over (cell, forced digit)
+            u16 seen[CELLS] = {0};
+            u8 qc[CELLS * 2], qd[CELLS * 2];
+            int head = 0, tail = 0;
+            qc[tail] = (u8)i;
+            qd[tail++] = (u8)__builtin_ctz(digits[i] & ~(1u << a));
+            seen[i] = (u16)(1u << qd[0]);
+            while (head < tail) {
+                int at = qc[head], v = qd[head++];
+                Bits reach = peers(cells[at]);
+                for (int j = 0; j < nb; j++) {
+                    if (j == i || !(digits[j] & (1u << v)) || !b_has(reach, cells[j])) continue;
+                    int w = __builtin_ctz(digits[j] & ~(1u << v));
+                    if (seen[j] & (1u << w)) continue;
+                    seen[j] |= (u16)(1u << w);
+                    if (w == a) {
+                        // The ends may see each other; neither loses a
+                        Bits both = b_andnot(b_and(start_peers, peers(cells[j])), b_cell(cells[i]));
+                        if (eliminate(s, a, both)) return n + 1;
+                    }
+                    qc[tail] = (u8)j;
+                    qd[tail++] = (u8)w;
+                }
+            }
+        }
+    return n;
+}
+
+static int chains(RateState *s) {
+    int n = colouring(s);
+    return n != 0 ? n : xy_chains(s);
+}
+
+static int (*const techniques[TECH_TRIAL])(RateState *s) = {
+    NULL, hidden_singles, naked_singles, locked_candidates, pairs, triples, quads, xwings, swordfish, chains,
+};
+
+void rate_puzzle(const u8 grid[CELLS], Technique ceiling, Rating *out) {
+    memset(out, 0, sizeof(*out));
+    RateState s;
+    memset(&s, 0, sizeof(s));
+    for (int d = 0; d < 9; d++) s.cand[d] = (Bits){{~0ull, 0x1FFFFull}};
+    s.empty = s.cand[0];
+
+    bool ok = true;
+    for (int i = 0; i < CELLS && ok; i++)
+        if (grid[i]) ok = grid[i] <= 9 && place(&s, i, grid[i] - 1);
+
+    while (ok && b_any(s.empty)) {
+        int t = TECH_HIDDEN_SINGLE, r = 0;
+        for (; t < TECH_TRIAL && t <= (int)ceiling; t++)
+            if ((r = techniques[t](&s)) != 0) break;
+        if (r <= 0) {
+            ok = false; // stuck, contradiction or over the ceiling
+            break;
+        }
+        out->steps[t] += r;
+        out->score += r * technique_weight[t];
+        if (t > (int)out->hardest) out->hardest = (Technique)t;
+    }
+    out->solved = ok;
+    if (!ok) out->hardest = TECH_TRIAL;
+}
+
+void make_puzzle_rated_seeded(Board *b, u64 seed, Technique max, Rating *out) {
+    const SearchConfig *config = &b->config;
+    Rng rng;
+    rng_seed(&rng, seed);
+    u8 solution[CELLS], grid[CELLS], order[CELLS];
+    generator_with(solution, &rng, config);
+    for (int i = 0; i < CELLS; i++) order[i] = (u8)i;
+    shuffle_u8(&rng, order, CELLS);
+
+    // Dig every cell, keeping removals that stay unique and within max
+    memcpy(grid, solution, CELLS);
+    int holes = 0;
+    for (int i = 0; i < CELLS; i++) {
+        int pos = order[i];
+        u8 known = grid[pos];
+        grid[pos] = 0;
+        // Most rejections near the end are ambiguous removals, which the
+        // uniqueness test finds far faster than a rating gets stuck
+        bool keep = dig_keeps_unique(grid, pos, known, config);
+        if (keep && max < TECH_TRIAL) {
+            Rating r;
+            rate_puzzle(grid, max, &r);
+            keep = r.solved;
+        }
+        if (keep) holes++;
+        else grid[pos] = known;
+    }
+
+    board_load(b, grid, solution, seed, holes);
+    if (out) rate_puzzle(grid, TECH_TRIAL, out);
+}
+
+bool make_puzzle_rated(Board *b, Technique min, Technique max, int max_attempts, Rating *out, int *attempts) {
+    u8 best[CELLS], best_solution[CELLS];
+    u64 best_seed = 0;
+    Rating best_rating;
+    bool hit = false;
+    int n = 0;
+    do {
+        Rating r;
+        make_puzzle_rated_seeded(b, rng_next(&b->rng), max, &r);
+        hit = r.hardest >= min && r.hardest <= max;
+        // Every attempt is at most max, so the hardest is the closest
+        if (n == 0 || hit || r.hardest > best_rating.hardest) {
+            memcpy(best, b->givens, CELLS);
+            memcpy(best_solution, b->solution, CELLS);
+            best_seed = b->seed;
+            best_rating = r;
+        }
+        n++;
+    } while (!hit && n < max_attempts);
+
+    if (b->seed != best_seed) {
+        int holes = 0;
+        for (int i = 0; i < CELLS; i++) holes += best[i] == 0;
+        board_load(b, best, best_solution, best_seed, holes);
+    }
+    if (out) *out = best_rating;
+    if (attempts) *attempts = n;
+    return hit;
+}
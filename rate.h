@@ -0,0 +1,56 @@
+#ifndef RATE_H
+#define RATE_H
+
+#include "sudoku.h"
+
+// Logical solver that grades a puzzle by the hardest technique a person
+// needs. Techniques run easiest first and the solver falls back to the
+// easiest after every step, so the hardest one used is the one required.
+// Candidates are kept as one 81-bit board per digit.
+typedef enum {
+    TECH_NONE,              // the grid is already full
+    TECH_HIDDEN_SINGLE,
+    TECH_NAKED_SINGLE,
+    TECH_LOCKED_CANDIDATES, // pointing and claiming
+    TECH_PAIR,              // naked and hidden pairs
+    TECH_TRIPLE,            // naked and hidden triples
+    TECH_QUAD,              // naked and hidden quads
+    TECH_XWING,
+    TECH_SWORDFISH,
+    TECH_CHAIN,             // simple colouring and XY-chains
+    TECH_TRIAL,             // none of the above progress: needs trial and error
+    TECH_COUNT
+} Technique;
+
+extern const char *const technique_names[TECH_COUNT];
+
+typedef struct {
+    Technique hardest;
+    int steps[TECH_COUNT]; // productive applications of each technique
+    int score;             // weighted step total, orders puzzles of one technique
+    bool solved;           // false if stuck (TECH_TRIAL) or the givens contradict
+} Rating;
+
+// Rate grid (0 = empty). Stops as soon as a technique harder than ceiling
+// would be needed, with hardest set to TECH_TRIAL; pass TECH_TRIAL to rate
+// fully. Reentrant and allocation-free.
+void rate_puzzle(const u8 grid[CELLS], Technique ceiling, Rating *out);
+
+// make_puzzle() for a band of hardest techniques instead of a hole count.
+// Each attempt is make_puzzle_rated_seeded() with a seed drawn from
+// b->rng, accepted if the puzzle needs at least min. Gives up after
+// max_attempts and returns false, leaving b on the attempt closest to the
+// band. out (the rating of the puzzle kept) and attempts (the number made)
+// may be NULL.
+bool make_puzzle_rated(Board *b, Technique min, Technique max, int max_attempts, Rating *out, int *attempts);
+
+// One attempt: fill a solution grid from seed and dig cells in random
+// order, keeping a removal only if the puzzle stays unique and still solves
+// with techniques up to max. That rating stops at the first harder
+// technique, so a puzzle is turned away from the band at the removal that
+// would leave it. Uses b->config like make_unique_puzzle_fast() and starts
+// the game on b with b->seed = seed; the same seed, max and config replay
+// the same puzzle. out may be NULL.
+void make_puzzle_rated_seeded(Board *b, u64 seed, Technique max, Rating *out);
+
+#endif // RATE_H
@@ -0,0 +1,176 @@
+// Streaming batch solver: one puzzle per line in, one result per line out.
+// Build: cc -O2 -o solve solve.c sudoku.c candidates.c dlx.c
+// Usage: ./solve [-c] [-q] [-x] [file]   (reads stdin without a file)
+//
+// Input lines hold 81 cells, digits 1-9 and '.' or '0' for empty; anything
+// after the 81st cell following whitespace is ignored, as are blank lines
+// and lines starting with '#'. Output is the first solution per puzzle, or
+// with -c one of unique/multiple/none; malformed or self-contradicting
+// lines give "invalid". -q prints only the summary, which goes to stderr.
+// -x solves with the Dancing Links backend instead of the backtracker.
+#define _POSIX_C_SOURCE 199309L
+#include "sudoku.h"
+#include "dlx.h"
+#include "timing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define READ_BUFFER (1 << 20)
+#define WRITE_BUFFER (1 << 20)
+
+typedef enum { RESULT_UNIQUE, RESULT_MULTIPLE, RESULT_NONE, RESULT_INVALID, RESULT_KINDS } Result;
+
+static const char *result_names[RESULT_KINDS] = {"unique", "multiple", "none", "invalid"};
+
+// 81 cells then end of line or whitespace
+static bool parse_line(const char *s, size_t len, u8 grid[CELLS]) {
+    if (len < CELLS || (len > CELLS && s[CELLS] != ' ' && s[CELLS] != '\t' && s[CELLS] != '\r')) return false;
+    for (int i = 0; i < CELLS; i++) {
+        char ch = s[i];
+        if (ch >= '1' && ch <= '9') grid[i] = (u8)(ch - '0');
+        else if (ch == '.' || ch == '0') grid[i] = 0;
+        else return false;
+    }
+    return true;
+}
+
+static bool keep_first(const u8 grid[CELLS], void *user) {
+    u8 *first = user;
+    if (first[0] == 0) memcpy(first, grid, CELLS);
+    return true;
+}
+
+typedef struct {
+    bool check;
+    bool quiet;
+    DlxSolver *dlx; // -x backend, NULL for the backtracker
+    long counts[RESULT_KINDS];
+    double *times; // seconds per solved line
+    size_t ntimes, cap;
+} Run;
+
+static void handle_line(Run *run, const char *s, size_t len) {
+    if (len && s[len - 1] == '\r') len--;
+    if (len == 0 || s[0] == '#') return;
+
+    u8 grid[CELLS], first[CELLS] = {0};
+    Result res = RESULT_INVALID;
+    CandidateMasks masks;
+    // The search assumes the givens do not already clash
+    if (parse_line(s, len, grid) && masks_init(&masks, grid)) {
+        double t0 = now_sec();
+        int found = run->dlx ? dlx_solve(run->dlx, grid, 2, run->check ? NULL : first)
+                             : enumerate_solutions(grid, 2, run->check ? NULL : keep_first, first, NULL);
+        double dt = now_sec() - t0;
+        res = found == 0 ? RESULT_NONE : found == 1 ? RESULT_UNIQUE : RESULT_MULTIPLE;
+
+        if (run->ntimes == run->cap) {
+            size_t cap = run->cap ? run->cap * 2 : 4096;
+            double *times = realloc(run->times, cap * sizeof(double));
+            if (times) {
+                run->times = times;
+                run->cap = cap;
+            }
+        }
+        if (run->ntimes < run->cap) run->times[run->ntimes++] = dt;
+    }
+    run->counts[res]++;
+    if (run->quiet) return;
+
+    if (!run->check && (res == RESULT_UNIQUE || res == RESULT_MULTIPLE)) {
+        char out[CELLS + 1];
+        for (int i = 0; i < CELLS; i++) out[i] = (char)('0' + first[i]);
+        out[CELLS] = '\n';
+        fwrite(out, 1, sizeof(out), stdout);
+    } else {
+        fputs(result_names[res], stdout);
+        putchar('\n');
+    }
+}
+
+// Split the input into lines through one large buffer; a line cut by the
+// end of a read is moved to the front and completed by the next
+static bool process(Run *run, FILE *in) {
+    char *buf = malloc(READ_BUFFER);
+    if (!buf) return false;
+    size_t have = 0;
+    bool skipping = false; // inside a line too long for the buffer
+    for (;;) {
+        size_t got = fread(buf + have, 1, READ_BUFFER - have, in);
+        have += got;
+        bool eof = got == 0;
+
+        size_t start = 0;
+        for (;;) {
+            char *nl = memchr(buf + start, '\n', have - start);
+            if (!nl) break;
+            size_t end = (size_t)(nl - buf);
+            if (!skipping) handle_line(run, buf + start, end - start);
+            skipping = false;
+            start = end + 1;
+        }
+        if (eof) {
+            if (start < have && !skipping) handle_line(run, buf + start, have - start);
+            break;
+        }
+        memmove(buf, buf + start, have - start);
+        have -= start;
+        if (have == READ_BUFFER) {
+            // No newline in a full buffer: judge the line by its start
+            if (!skipping) handle_line(run, buf, have);
+            skipping = true;
+            have = 0;
+        }
+    }
+    bool ok = !ferror(in);
+    free(buf);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    static DlxSolver dlx;
+    Run run = {0};
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-c") == 0) run.check = true;
+        else if (strcmp(argv[i], "-q") == 0) run.quiet = true;
+        else if (strcmp(argv[i], "-x") == 0) run.dlx = &dlx;
+        else if (argv[i][0] == '-' || path) {
+            fprintf(stderr, "usage: %s [-c] [-q] [-x] [file]\n", argv[0]);
+            return 2;
+        } else path = argv[i];
+    }
+
+    if (run.dlx) dlx_init(run.dlx);
+    FILE *in = path ? fopen(path, "rb") : stdin;
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    static char out_buf[WRITE_BUFFER];
+    setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+
+    double t0 = now_sec();
+    bool ok = process(&run, in);
+    double wall = now_sec() - t0;
+    if (path) fclose(in);
+    if (fflush(stdout) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "%s: read or write error\n", argv[0]);
+        return 1;
+    }
+
+    long total = 0;
+    for (int k = 0; k < RESULT_KINDS; k++) total += run.counts[k];
+    fprintf(stderr, "%ld puzzles: %ld unique, %ld multiple, %ld none, %ld invalid\n", total,
+            run.counts[RESULT_UNIQUE], run.counts[RESULT_MULTIPLE], run.counts[RESULT_NONE], run.counts[RESULT_INVALID]);
+    if (run.ntimes > 0) {
+        qsort(run.times, run.ntimes, sizeof(double), cmp_double);
+        double p50 = run.times[run.ntimes / 2], p99 = run.times[(run.ntimes * 99) / 100];
+        fprintf(stderr, "%.1f puzzles/sec  p50 %.3f ms  p99 %.3f ms  max %.3f ms\n", total / wall, p50 * 1e3,
+                p99 * 1e3, run.times[run.ntimes - 1] * 1e3);
+    }
+    free(run.times);
+    return 0;
+}
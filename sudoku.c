@@ -1,16 +1,21 @@
+#define _POSIX_C_SOURCE 199309L
 #include "sudoku.h"
+#include "candidates.h"
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
 
-u8 grid[CELLS] = {0};
-u8 initial_grid[CELLS] = {0};
-u8 solution_grid[CELLS] = {0};
-
-int difficultyHoles = MEDIUM_HOLES;
-int mistakes = 0;
-const int maxMistakes = 3;
-bool showSolution = false;
-bool gameComplete = false;
+SearchConfig searchDefaults = {
+    .branch = BRANCH_MRV,
+    .fill = FILL_DIAGONAL,
+    .propagate = true,
+#ifdef __EMSCRIPTEN__
+    .iterative = true,
+#else
+    .iterative = false,
+#endif
+    .dig_by_exclusion = true,
+};
 
 bool is_valid(const u8 grid[CELLS], int row, int col, u8 val) {
     for (int i = 0; i < 9; i++) {
@@ -36,104 +41,898 @@ bool find_empty(const u8 grid[CELLS], int *row, int *col) {
     return false;
 }
 
-void shuffle_u8(u8 *arr, int n) {
+// Most constrained empty cell by precomputed candidates, -1 if the grid is full
+static int mrv_cell(const u8 grid[CELLS], const u16 cands[CAND_PAD]) {
+    int best = 10;
+    int cell = -1;
+    for (int i = 0; i < CELLS; i++) {
+        if (grid[i] != 0) continue;
+        int n = candidate_count(cands[i]);
+        if (n < best) {
+            best = n;
+            cell = i;
+            if (n <= 1) break;
+        }
+    }
+    return cell;
+}
+
+// Most constrained empty cell; a cell with no candidates is returned at once
+bool find_empty_mrv(const u8 grid[CELLS], const CandidateMasks *m, int *row, int *col) {
+    u16 cands[CAND_PAD];
+
+    candidates_all(grid, m, cands);
+    int cell = mrv_cell(grid, cands);
+    if (cell < 0) return false;
+    *row = cell / 9;
+    *col = cell % 9;
+    return true;
+}
+
+void shuffle_u8(Rng *rng, u8 *arr, int n) {
     for (int i = n - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = (int)rng_below(rng, (u32)(i + 1));
         u8 tmp = arr[i];
         arr[i] = arr[j];
         arr[j] = tmp;
     }
 }
 
-bool generator_recursive(u8 grid[CELLS]) {
-    int row, col;
+bool masks_init(CandidateMasks *m, const u8 grid[CELLS]) {
+    memset(m, 0, sizeof(*m));
+    bool ok = true;
+    for (int r = 0; r < 9; r++)
+        for (int c = 0; c < 9; c++) {
+            u8 val = grid[idx(r, c)];
+            if (val == 0) continue;
+            if (!(masks_candidates(m, r, c) & digit_bit(val))) ok = false; // already in a unit
+            masks_place(m, r, c, val);
+        }
+    return ok;
+}
 
-    if (!find_empty(grid, &row, &col)) return true;
-    u8 order[9];
+// Working state shared by the recursive searches
+typedef struct {
+    u8 *grid;
+    const SearchConfig *config;
+    Rng *rng; // digit order for the generators
+    CandidateMasks masks;
+    u8 trail[CELLS]; // cells placed by propagation, undone in reverse
+    int trail_len;
+    int limit;       // stop after this many solutions, 0 for no limit
+    int found;
+    long nodes;      // search nodes visited
+    bool stopped;    // the solution callback asked to stop
+    SolutionCallback on_solution;
+    void *user;
+#if SEARCH_STATS
+    SearchStats *stats; // NULL to not collect
+    int depth;          // branching cells on the current path
+#endif
+} SearchState;
+
+// Run stmt with st = s->stats when collecting; nothing without SEARCH_STATS
+#if SEARCH_STATS
+#define STAT(s, stmt)                        \
+    do {                                     \
+        SearchStats *st = (s)->stats;        \
+        if (st) {                            \
+            stmt;                            \
+        }                                    \
+    } while (0)
+#else
+#define STAT(s, stmt) ((void)0)
+#endif
+
+// board_stats(b) is where a Board collects, NULL without SEARCH_STATS
+#if SEARCH_STATS
+#define STAT_UNIQUENESS(stats) ((stats)->uniqueness_checks++)
+#define stats_reset(stats) memset((stats), 0, sizeof(SearchStats))
+#define board_stats(b) (&(b)->stats)
+#else
+#define STAT_UNIQUENESS(stats) ((void)0)
+#define stats_reset(stats) ((void)0)
+#define board_stats(b) ((SearchStats *)NULL)
+#endif
+
+// Statistics of a node that branches at the current depth
+#define STAT_BRANCH(s, depth)                                       \
+    STAT(s, {                                                       \
+        st->depth_nodes[depth]++;                                   \
+        if ((depth) + 1 > st->max_depth) st->max_depth = (depth) + 1; \
+    })
+
+static void search_init(SearchState *s, u8 grid[CELLS], const SearchConfig *config) {
+    s->grid = grid;
+    s->config = config;
+    s->rng = NULL;
+    masks_init(&s->masks, grid);
+    s->trail_len = 0;
+    s->limit = 2; // enough to tell unique from ambiguous
+    s->found = 0;
+    s->nodes = 0;
+    s->stopped = false;
+    s->on_solution = NULL;
+    s->user = NULL;
+#if SEARCH_STATS
+    s->stats = NULL;
+    s->depth = 0;
+#endif
+}
+
+static inline void search_collect(SearchState *s, SearchStats *stats) {
+#if SEARCH_STATS
+    s->stats = stats;
+#else
+    (void)s;
+    (void)stats;
+#endif
+}
+
+static inline bool search_done(const SearchState *s) {
+    return s->stopped || (s->limit > 0 && s->found >= s->limit);
+}
+
+// The grid is complete: count it and hand it to the callback in place
+static void search_solution(SearchState *s) {
+    s->found++;
+    if (s->on_solution && !s->on_solution(s->grid, s->user)) s->stopped = true;
+}
+
+static inline void search_place(SearchState *s, int cell, u8 val) {
+    s->grid[cell] = val;
+    masks_place(&s->masks, cell / 9, cell % 9, val);
+}
+
+static inline void search_clear(SearchState *s, int cell) {
+    masks_remove(&s->masks, cell / 9, cell % 9, s->grid[cell]);
+    s->grid[cell] = 0;
+}
+
+static void search_undo(SearchState *s, int mark) {
+    while (s->trail_len > mark) search_clear(s, s->trail[--s->trail_len]);
+}
+
+// Place val if it is still legal; earlier placements in the same pass may have taken it
+static bool trail_place(SearchState *s, int cell, u8 val) {
+    if (s->grid[cell] != 0 || !(masks_candidates(&s->masks, cell / 9, cell % 9) & digit_bit(val))) return false;
+    search_place(s, cell, val);
+    s->trail[s->trail_len++] = (u8)cell;
+    return true;
+}
+
+static inline u16 unit_placed(const CandidateMasks *m, int u) {
+    if (u < 9) return m->rows[u];
+    if (u < 18) return m->cols[u - 9];
+    return m->boxes[u - 18];
+}
+
+// Place naked and hidden singles until none are left. Returns false on a
+// contradiction: an empty cell with no candidates, or a digit with no place
+// left in some unit. On return cands holds the candidates of the final state.
+static bool propagate(SearchState *s, u16 cands[CAND_PAD]) {
+    for (;;) {
+        bool changed = false;
+        u64 singles[2];
+
+        candidates_all(s->grid, &s->masks, cands);
+        for (int i = 0; i < CELLS; i++)
+            if (s->grid[i] == 0 && cands[i] == 0) return false;
+
+        if (candidates_naked_singles(cands, singles) > 0) {
+            for (int w = 0; w < 2; w++)
+                for (u64 bits = singles[w]; bits; bits &= bits - 1) {
+                    int cell = w * 64 + __builtin_ctzll(bits);
+                    changed |= trail_place(s, cell, (u8)(__builtin_ctz(cands[cell]) + 1));
+                }
+            // A skipped single means a conflict, which the next pass reports
+            continue;
+        }
+
+        for (int u = 0; u < 27; u++) {
+            u16 once = 0, twice = 0;
+            for (int k = 0; k < 9; k++) {
+                u16 c = cands[unit_cell(u, k)];
+                twice |= once & c;
+                once |= c;
+            }
+            if ((once | unit_placed(&s->masks, u)) != ALL_CANDIDATES) return false;
+
+            for (u16 hidden = once & ~twice; hidden; hidden &= hidden - 1) {
+                u16 b = hidden & -hidden;
+                for (int k = 0; k < 9; k++) {
+                    int cell = unit_cell(u, k);
+                    if (cands[cell] & b) {
+                        changed |= trail_place(s, cell, (u8)(__builtin_ctz(b) + 1));
+                        break;
+                    }
+                }
+            }
+        }
+        if (!changed) return true;
+    }
+}
+
+// Prepare a branching node: propagate if enabled and choose the branch cell.
+// Returns the cell, -1 when the grid is full, -2 on a contradiction.
+static int search_node(SearchState *s, u16 cands[CAND_PAD]) {
+    s->nodes++;
+    STAT(s, st->nodes++);
+    if (s->config->propagate) {
+        if (!propagate(s, cands)) {
+            STAT(s, st->backtracks++);
+            return -2;
+        }
+    } else if (s->config->branch != BRANCH_FIRST_EMPTY) {
+        candidates_all(s->grid, &s->masks, cands);
+    }
+
+    if (s->config->branch == BRANCH_FIRST_EMPTY) {
+        int row, col;
+        return find_empty(s->grid, &row, &col) ? idx(row, col) : -1;
+    }
+    return mrv_cell(s->grid, cands);
+}
+
+static bool generate_fill(SearchState *s) {
+    u16 cands[CAND_PAD];
+    int mark = s->trail_len;
+
+    int cell = search_node(s, cands);
+    if (cell == -1) return true;
+    if (cell == -2) {
+        search_undo(s, mark);
+        return false;
+    }
 
+    u16 legal = masks_candidates(&s->masks, cell / 9, cell % 9);
+    u8 order[9];
     for (int i = 0; i < 9; i++) order[i] = i + 1;
 
-    shuffle_u8(order, 9);
+    shuffle_u8(s->rng, order, 9);
 
     for (int k = 0; k < 9; k++) {
         u8 v = order[k];
-        if (is_valid(grid, row, col, v)) {
-            grid[idx(row, col)] = v;
-            if (generator_recursive(grid)) return true;
-            grid[idx(row, col)] = 0;
+        if (legal & digit_bit(v)) {
+            search_place(s, cell, v);
+            if (generate_fill(s)) return true;
+            search_clear(s, cell);
         }
     }
+    search_undo(s, mark);
     return false;
 }
 
+// FILL_DIAGONAL: boxes 1, 5 and 9 share no row or column, so each takes an
+// independent random permutation before the search fills the rest
+static void generate_begin(SearchState *s) {
+    if (s->config->fill != FILL_DIAGONAL) return;
+    for (int b = 0; b < 9; b += 4) {
+        u8 digits[9];
+        for (int i = 0; i < 9; i++) digits[i] = (u8)(i + 1);
+        shuffle_u8(s->rng, digits, 9);
+        for (int k = 0; k < 9; k++) search_place(s, idx((b / 3) * 3 + k / 3, (b % 3) * 3 + k % 3), digits[k]);
+    }
+}
 
+bool generator_recursive(u8 grid[CELLS], Rng *rng) {
+    if (searchDefaults.fill == FILL_TRANSFORM) return generator_transform(grid, rng);
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    s.rng = rng;
+    generate_begin(&s);
+    return generate_fill(&s);
+}
 
-int count_solutions(u8 grid[CELLS]) {
-    int row, col;
-    int total = 0;
-
-    if (!find_empty(grid, &row, &col)) return 1; // full grid = 1 solution
-
-    for (int val = 1; val <= 9; val++) {
-        if (is_valid(grid, row, col, val)) {
-            grid[idx(row, col)] = val;
-            total += count_solutions(grid);
-            if (total > 1) { // early exit if more than 1 solution
-                grid[idx(row, col)] = 0;
-                return total;
+// Number of empty peers of (row, col) that still allow val
+static int peer_conflicts(const u8 grid[CELLS], const CandidateMasks *m, int row, int col, u8 val) {
+    u16 b = digit_bit(val);
+    int br = (row / 3) * 3;
+    int bc = (col / 3) * 3;
+    int n = 0;
+    for (int i = 0; i < 9; i++) {
+        if (i != col && grid[idx(row, i)] == 0 && (masks_candidates(m, row, i) & b)) n++;
+        if (i != row && grid[idx(i, col)] == 0 && (masks_candidates(m, i, col) & b)) n++;
+        int r = br + i / 3, c = bc + i % 3;
+        if (r != row && c != col && grid[idx(r, c)] == 0 && (masks_candidates(m, r, c) & b)) n++;
+    }
+    return n;
+}
+
+// Fill order[] with the legal digits of cell, ascending or least-constraining first
+static int branch_order(const SearchState *s, int cell, u8 order[9]) {
+    int row = cell / 9, col = cell % 9;
+    u16 cands = masks_candidates(&s->masks, row, col);
+    int n = 0;
+    int cost[9];
+    while (cands) {
+        u8 val = (u8)(__builtin_ctz(cands) + 1);
+        cands &= cands - 1;
+
+        int k = n++;
+        if (s->config->branch == BRANCH_MRV_LCV) {
+            int cv = peer_conflicts(s->grid, &s->masks, row, col, val);
+            for (; k > 0 && cost[k - 1] > cv; k--) {
+                cost[k] = cost[k - 1];
+                order[k] = order[k - 1];
             }
-            grid[idx(row, col)] = 0;
+            cost[k] = cv;
         }
+        order[k] = val;
     }
-    return total;
+    return n;
 }
 
-void make_unique_puzzle_fast(u8 current_grid[CELLS], u8 fixed_grid[CELLS], int holes) {
-    memset(current_grid, 0, CELLS);
-    memset(fixed_grid, 0, CELLS);
+static void count_fill(SearchState *s) {
+    u16 cands[CAND_PAD];
+    int mark = s->trail_len;
 
-    u8 fullGrid[CELLS] = {0};
-    generator_recursive(fullGrid);             // generate full solution
-    memcpy(solution_grid, fullGrid, CELLS);   // store solution
-    memcpy(current_grid, fullGrid, CELLS);    // start puzzle grid as full solution
-    memcpy(fixed_grid, fullGrid, CELLS);      // fixed grid for static cells
+    int cell = search_node(s, cands);
+    if (cell < 0) {
+        if (cell == -1) search_solution(s); // full grid = 1 solution
+        search_undo(s, mark);
+        return;
+    }
+
+    u8 order[9];
+    int n = branch_order(s, cell, order);
+    if (n == 0) STAT(s, st->backtracks++);
+    else STAT_BRANCH(s, s->depth);
+    for (int k = 0; k < n && !search_done(s); k++) { // early exit at the limit
+        STAT(s, st->depth_children[s->depth++]++);
+        search_place(s, cell, order[k]);
+        count_fill(s);
+        search_clear(s, cell);
+        STAT(s, s->depth--);
+    }
+    search_undo(s, mark);
+}
+
+int count_solutions(u8 grid[CELLS]) {
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    count_fill(&s);
+    return s.found;
+}
+
+#if SEARCH_STATS
+int count_solutions_stats(u8 grid[CELLS], SearchStats *stats) {
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    search_collect(&s, stats);
+    count_fill(&s);
+    return s.found;
+}
+#endif
+
+int enumerate_solutions(u8 grid[CELLS], int limit, SolutionCallback on_solution, void *user, long *nodes) {
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    s.limit = limit > 0 ? limit : 0;
+    s.on_solution = on_solution;
+    s.user = user;
+    count_fill(&s);
+    if (nodes) *nodes = s.nodes;
+    return s.found;
+}
+
+// One branching node of the iterative searches
+typedef struct {
+    u8 cell;     // branch cell
+    u8 mark;     // trail length before this node's propagation
+    u8 next;     // values order[0..next) have been tried
+    u8 count;
+    u8 order[9];
+} SearchFrame;
+
+// One node of count_iter(): 1 once the search is over (s->found holds the
+// count), 0 to keep stepping. Resumable like generate_step().
+static int count_step(SearchState *s, SearchFrame stack[CELLS], int *depth) {
+    u16 cands[CAND_PAD];
+    int mark = s->trail_len;
+    int cell = search_node(s, cands);
+    bool leaf = true;
+
+    if (cell >= 0) {
+        SearchFrame *f = &stack[*depth];
+        f->cell = (u8)cell;
+        f->mark = (u8)mark;
+        f->next = 0;
+        f->count = (u8)branch_order(s, cell, f->order);
+        if (f->count > 0) {
+            STAT_BRANCH(s, *depth);
+            (*depth)++;
+            leaf = false;
+        } else {
+            STAT(s, st->backtracks++);
+        }
+    }
+
+    if (leaf) {
+        if (cell == -1) search_solution(s);
+        search_undo(s, mark);
+        // Back up until a node has another value to try
+        for (;;) {
+            if (*depth == 0) return 1;
+            SearchFrame *f = &stack[*depth - 1];
+            search_clear(s, f->cell);
+            if (!search_done(s) && f->next < f->count) break; // early exit at the limit
+            search_undo(s, f->mark);
+            (*depth)--;
+        }
+    }
+
+    SearchFrame *f = &stack[*depth - 1];
+    STAT(s, st->depth_children[*depth - 1]++);
+    search_place(s, f->cell, f->order[f->next++]);
+    return 0;
+}
+
+// count_fill() with an explicit stack; visits nodes in the same order
+static void count_iter(SearchState *s) {
+    SearchFrame stack[CELLS];
+    int depth = 0;
+    while (count_step(s, stack, &depth) == 0) {}
+}
+
+int count_solutions_iterative(u8 grid[CELLS]) {
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    count_iter(&s);
+    return s.found;
+}
+
+// One node of generate_iter(): 1 once the grid is full, -1 if the search
+// is exhausted, 0 to keep stepping. Resumable, so a fill can be spread over
+// several calls.
+static int generate_step(SearchState *s, SearchFrame stack[CELLS], int *depth) {
+    u16 cands[CAND_PAD];
+    int mark = s->trail_len;
+    int cell = search_node(s, cands);
+    if (cell == -1) return 1;
+
+    bool dead = cell == -2;
+    if (!dead) {
+        SearchFrame *f = &stack[*depth];
+        u16 legal = masks_candidates(&s->masks, cell / 9, cell % 9);
+        u8 order[9];
+        for (int i = 0; i < 9; i++) order[i] = i + 1;
+
+        shuffle_u8(s->rng, order, 9);
+
+        f->cell = (u8)cell;
+        f->mark = (u8)mark;
+        f->next = 0;
+        f->count = 0;
+        for (int k = 0; k < 9; k++)
+            if (legal & digit_bit(order[k])) f->order[f->count++] = order[k];
+        if (f->count == 0) dead = true;
+        else (*depth)++;
+    }
+
+    if (dead) {
+        search_undo(s, mark);
+        for (;;) {
+            if (*depth == 0) return -1;
+            SearchFrame *f = &stack[*depth - 1];
+            search_clear(s, f->cell);
+            if (f->next < f->count) break;
+            search_undo(s, f->mark);
+            (*depth)--;
+        }
+    }
+
+    SearchFrame *f = &stack[*depth - 1];
+    search_place(s, f->cell, f->order[f->next++]);
+    return 0;
+}
+
+// generate_fill() with an explicit stack; consumes the Rng identically
+static bool generate_iter(SearchState *s) {
+    SearchFrame stack[CELLS];
+    int depth = 0, r;
+    while ((r = generate_step(s, stack, &depth)) == 0) {}
+    return r > 0;
+}
+
+bool generator_iterative(u8 grid[CELLS], Rng *rng) {
+    if (searchDefaults.fill == FILL_TRANSFORM) return generator_transform(grid, rng);
+    SearchState s;
+    search_init(&s, grid, &searchDefaults);
+    s.rng = rng;
+    generate_begin(&s);
+    return generate_iter(&s);
+}
+
+// Solution grid the transform generator starts from, found by backtracking
+// so it has no symmetry of its own to shrink the set of transformed grids
+static const u8 transform_base[CELLS] = {
+    7, 2, 6, 3, 5, 8, 4, 9, 1,
+    9, 1, 5, 4, 6, 7, 2, 8, 3,
+    8, 4, 3, 2, 1, 9, 7, 6, 5,
+    2, 7, 1, 5, 8, 6, 3, 4, 9,
+    5, 6, 4, 9, 2, 3, 8, 1, 7,
+    3, 8, 9, 1, 7, 4, 6, 5, 2,
+    6, 9, 7, 8, 3, 1, 5, 2, 4,
+    1, 3, 2, 6, 4, 5, 9, 7, 8,
+    4, 5, 8, 7, 9, 2, 1, 3, 6,
+};
+
+// Random order of the 9 rows (or columns): bands shuffled, rows shuffled within each
+static void line_order(Rng *rng, u8 order[9]) {
+    u8 bands[3] = {0, 1, 2};
+    shuffle_u8(rng, bands, 3);
+    for (int b = 0; b < 3; b++) {
+        u8 lines[3] = {0, 1, 2};
+        shuffle_u8(rng, lines, 3);
+        for (int i = 0; i < 3; i++) order[b * 3 + i] = (u8)(bands[b] * 3 + lines[i]);
+    }
+}
+
+void grid_transform(u8 out[CELLS], const u8 base[CELLS], Rng *rng) {
+    u8 digits[9], rows[9], cols[9];
+    for (int i = 0; i < 9; i++) digits[i] = (u8)(i + 1);
+    shuffle_u8(rng, digits, 9);
+    line_order(rng, rows);
+    line_order(rng, cols);
+    bool transpose = rng_below(rng, 2) != 0;
+
+    for (int r = 0; r < 9; r++)
+        for (int c = 0; c < 9; c++) {
+            u8 v = transpose ? base[idx(cols[c], rows[r])] : base[idx(rows[r], cols[c])];
+            out[idx(r, c)] = v ? digits[v - 1] : 0;
+        }
+}
+
+bool generator_transform(u8 grid[CELLS], Rng *rng) {
+    grid_transform(grid, transform_base, rng);
+    return true;
+}
+
+static bool other_solution(u8 grid[CELLS], int pos, u8 known, const SearchConfig *config, SearchStats *stats) {
+    SearchState s;
+    search_init(&s, grid, config);
+    search_collect(&s, stats);
+    s.limit = 1;
+
+    int row = pos / 9, col = pos % 9;
+    u16 cands = masks_candidates(&s.masks, row, col) & ~digit_bit(known);
+    while (cands && s.found == 0) {
+        u8 val = (u8)(__builtin_ctz(cands) + 1);
+        cands &= cands - 1;
+
+        search_place(&s, pos, val);
+        if (config->iterative) count_iter(&s);
+        else count_fill(&s);
+        search_clear(&s, pos);
+    }
+    return s.found > 0;
+}
+
+bool has_other_solution(u8 grid[CELLS], int pos, u8 known) {
+    return other_solution(grid, pos, known, &searchDefaults, NULL);
+}
+
+int solve_singles(u8 grid[CELLS]) {
+    SearchState s;
+    u16 cands[CAND_PAD];
+    search_init(&s, grid, &searchDefaults);
+    if (!propagate(&s, cands)) {
+        search_undo(&s, 0);
+        return -1;
+    }
+    return s.trail_len;
+}
+
+void board_init(Board *b) {
+    memset(b, 0, sizeof(*b));
+    b->config = searchDefaults;
+    b->holes = MEDIUM_HOLES;
+    rng_seed(&b->rng, 1);
+}
+
+void board_seed(Board *b, u64 seed) {
+    rng_seed(&b->rng, seed);
+}
+
+void board_set(Board *b, int cell, u8 val) {
+    int row = cell / 9, col = cell % 9;
+    if (b->values[cell] != 0) masks_remove(&b->masks, row, col, b->values[cell]);
+    b->values[cell] = val;
+    if (val != 0) masks_place(&b->masks, row, col, val);
+}
+
+// Start the puzzle as the full solution and shuffle the order cells are dug in
+static void dig_begin(Board *b, Rng *rng, int indices[CELLS]) {
+    memcpy(b->values, b->solution, CELLS); // start puzzle grid as full solution
+    memcpy(b->givens, b->solution, CELLS); // fixed grid for static cells
 
-    // create an array
-    int indices[CELLS];
     for (int i = 0; i < CELLS; i++) indices[i] = i;
 
     // shuffle indices to remove numbers in random order
     for (int i = CELLS - 1; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = (int)rng_below(rng, (u32)(i + 1));
         int tmp = indices[i];
         indices[i] = indices[j];
         indices[j] = tmp;
     }
+}
+
+// Uniqueness test of hole digging: the exclusion search, or a full count
+static bool keeps_unique(u8 grid[CELLS], int pos, u8 known, const SearchConfig *config, SearchStats *stats) {
+    if (config->dig_by_exclusion) return !other_solution(grid, pos, known, config, stats);
+    SearchState s;
+    search_init(&s, grid, config);
+    search_collect(&s, stats);
+    if (config->iterative) count_iter(&s);
+    else count_fill(&s);
+    return s.found == 1;
+}
+
+bool dig_keeps_unique(u8 grid[CELLS], int pos, u8 known, const SearchConfig *config) {
+    return keeps_unique(grid, pos, known, config, NULL);
+}
+
+// Empty pos if the puzzle stays unique; true if it was removed
+static bool dig_cell(Board *b, int pos) {
+    const SearchConfig *config = &b->config;
+    u8 *current_grid = b->values;
+    u8 *fixed_grid = b->givens;
+    if (current_grid[pos] == 0) return false;
+
+    u8 backup = current_grid[pos];
+    current_grid[pos] = 0;
+    fixed_grid[pos] = 0;
+    STAT_UNIQUENESS(board_stats(b));
+
+    if (!keeps_unique(current_grid, pos, backup, config, board_stats(b))) {
+        // restore if uniqueness is lost
+        current_grid[pos] = backup;
+        fixed_grid[pos] = backup;
+        return false;
+    }
+    return true;
+}
+
+// Full solution grid as config->fill and config->iterative say
+static void fill_solution(u8 grid[CELLS], Rng *rng, const SearchConfig *config, SearchStats *stats) {
+    if (config->fill == FILL_TRANSFORM) {
+        grid_transform(grid, transform_base, rng);
+        return;
+    }
+    SearchState s;
+    memset(grid, 0, CELLS);
+    search_init(&s, grid, config);
+    search_collect(&s, stats);
+    s.rng = rng;
+    generate_begin(&s);
+    if (config->iterative) generate_iter(&s);
+    else generate_fill(&s);
+}
+
+void generator_with(u8 grid[CELLS], Rng *rng, const SearchConfig *config) {
+    fill_solution(grid, rng, config, NULL);
+}
+
+void make_unique_puzzle_fast(Board *b, int holes) {
+    const SearchConfig *config = &b->config;
+
+    Rng rng;
+    rng_seed(&rng, b->seed);
+    stats_reset(board_stats(b));
+
+    fill_solution(b->solution, &rng, config, board_stats(b));
+    int indices[CELLS];
+    dig_begin(b, &rng, indices);
 
     int removed = 0;
 
     // Remove numbers following the shuffled order
-    for (int i = 0; i < CELLS && removed < holes; i++) {
-        int pos = indices[i];
-        if (current_grid[pos] != 0) {
-            u8 backup = current_grid[pos];
-            current_grid[pos] = 0;
-            fixed_grid[pos] = 0;
-
-            if (count_solutions(current_grid) != 1) {
-                // restore if uniqueness is lost
-                current_grid[pos] = backup;
-                fixed_grid[pos] = backup;
-            } else {
-                removed++;
+    for (int i = 0; i < CELLS && removed < holes; i++)
+        if (dig_cell(b, indices[i])) removed++;
+    masks_init(&b->masks, b->values);
+}
+
+
+static void board_new_game(Board *b, int holes) {
+    b->holes = holes;
+    b->mistakes = 0;
+    b->show_solution = false;
+    b->complete = false;
+}
+
+void make_puzzle_seeded(Board *b, u64 seed, int holes) {
+    b->seed = seed;
+    make_unique_puzzle_fast(b, holes);
+    board_new_game(b, holes);
+}
+
+void board_load(Board *b, const u8 givens[CELLS], const u8 solution[CELLS], u64 seed, int holes) {
+    memcpy(b->values, givens, CELLS);
+    memcpy(b->givens, givens, CELLS);
+    memcpy(b->solution, solution, CELLS);
+    masks_init(&b->masks, b->values);
+    stats_reset(board_stats(b));
+    b->seed = seed;
+    board_new_game(b, holes);
+}
+
+void make_puzzle(Board *b, int holes) {
+    make_puzzle_seeded(b, rng_next(&b->rng), holes);
+}
+
+bool is_complete(const Board *b) {
+    for (int i = 0; i < CELLS; i++)
+        if (b->values[i] == 0) return false;
+    return true;
+}
+
+//
+// Frame-sliced generation
+//
+
+enum { JOB_FILL, JOB_DIG, JOB_CHECK, JOB_DONE };
+
+struct PuzzleJob {
+    Board work;
+    Rng rng;
+    int phase;
+    int holes;
+    // JOB_FILL: generate_iter() unrolled into resumable steps
+    SearchState fill;
+    SearchFrame stack[CELLS];
+    int depth;
+    // JOB_DIG picks the next cell to empty, JOB_CHECK runs its uniqueness
+    // test (dig_cell() unrolled) one search node per step
+    int indices[CELLS];
+    int next;
+    int removed;
+    SearchState check;
+    int check_depth;
+    int pos;
+    u8 known;
+    u16 others;  // values of pos still to exclude, dig_by_exclusion only
+    bool placed; // one of them is on pos and being searched
+};
+
+static long now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+PuzzleJob *puzzle_job_create(const SearchConfig *config) {
+    PuzzleJob *job = calloc(1, sizeof(*job));
+    if (!job) return NULL;
+    board_init(&job->work);
+    job->work.config = *config;
+    job->phase = JOB_DONE;
+    return job;
+}
+
+void puzzle_job_destroy(PuzzleJob *job) {
+    free(job);
+}
+
+void puzzle_job_start(PuzzleJob *job, u64 seed, int holes) {
+    job->work.seed = seed;
+    job->holes = holes;
+    rng_seed(&job->rng, seed);
+    memset(job->work.solution, 0, CELLS);
+    stats_reset(board_stats(&job->work));
+    search_init(&job->fill, job->work.solution, &job->work.config);
+    search_collect(&job->fill, board_stats(&job->work));
+    job->fill.rng = &job->rng;
+    generate_begin(&job->fill);
+    job->depth = 0;
+    job->next = 0;
+    job->removed = 0;
+    job->phase = JOB_FILL;
+}
+
+// Empty the next cell in dig order and set up its uniqueness test
+static void job_dig(PuzzleJob *job) {
+    Board *b = &job->work;
+    if (job->next >= CELLS || job->removed >= job->holes) {
+        masks_init(&b->masks, b->values);
+        job->phase = JOB_DONE;
+        return;
+    }
+    int pos = job->indices[job->next++];
+    if (b->values[pos] == 0) return;
+
+    job->pos = pos;
+    job->known = b->values[pos];
+    b->values[pos] = 0;
+    b->givens[pos] = 0;
+    STAT_UNIQUENESS(board_stats(b));
+    search_init(&job->check, b->values, &b->config);
+    search_collect(&job->check, board_stats(b));
+    if (b->config.dig_by_exclusion) {
+        job->check.limit = 1;
+        job->others = masks_candidates(&job->check.masks, pos / 9, pos % 9) & ~digit_bit(job->known);
+    }
+    job->check_depth = 0;
+    job->placed = false;
+    job->phase = JOB_CHECK;
+}
+
+static void job_checked(PuzzleJob *job, bool ambiguous) {
+    if (ambiguous) {
+        // restore if uniqueness is lost
+        job->work.values[job->pos] = job->known;
+        job->work.givens[job->pos] = job->known;
+    } else {
+        job->removed++;
+    }
+    job->phase = JOB_DIG;
+}
+
+// One step of the uniqueness test, same outcome as dig_cell()
+static void job_check(PuzzleJob *job) {
+    SearchState *s = &job->check;
+    if (!job->work.config.dig_by_exclusion) {
+        if (count_step(s, job->stack, &job->check_depth)) job_checked(job, s->found != 1);
+        return;
+    }
+    if (job->placed) {
+        if (count_step(s, job->stack, &job->check_depth)) {
+            search_clear(s, job->pos);
+            job->placed = false;
+        }
+    } else if (job->others == 0 || s->found > 0) {
+        job_checked(job, s->found > 0);
+    } else {
+        u8 val = (u8)(__builtin_ctz(job->others) + 1);
+        job->others &= job->others - 1;
+        search_place(s, job->pos, val);
+        job->check_depth = 0;
+        job->placed = true;
+    }
+}
+
+bool puzzle_job_step(PuzzleJob *job, long budget_us) {
+    long deadline = now_us() + budget_us;
+    int steps = 0;
+
+    while (job->phase != JOB_DONE) {
+        switch (job->phase) {
+        case JOB_FILL:
+            if (job->work.config.fill == FILL_TRANSFORM) {
+                grid_transform(job->work.solution, transform_base, &job->rng);
+                dig_begin(&job->work, &job->rng, job->indices);
+                job->phase = JOB_DIG;
+            } else if (generate_step(&job->fill, job->stack, &job->depth) != 0) {
+                dig_begin(&job->work, &job->rng, job->indices);
+                job->phase = JOB_DIG;
             }
+            break;
+        case JOB_DIG:
+            job_dig(job);
+            break;
+        case JOB_CHECK:
+            job_check(job);
+            break;
         }
+        // Steps are a search node or less, so only look at the clock now and then
+        if ((++steps & 7) == 0 && now_us() >= deadline) break;
     }
+    return job->phase == JOB_DONE;
 }
 
+float puzzle_job_progress(const PuzzleJob *job) {
+    if (job->phase == JOB_DONE) return 1.0f;
+    if (job->phase == JOB_FILL) {
+        int filled = 0;
+        for (int i = 0; i < CELLS; i++) filled += job->work.solution[i] != 0;
+        return 0.1f * (float)filled / CELLS;
+    }
+    return 0.1f + 0.9f * (float)job->removed / (job->holes > 0 ? job->holes : 1);
+}
 
-bool is_complete() {
-    for (int i = 0; i < CELLS; i++)
-        if (grid[i] == 0) return false;
-    return true;
+void puzzle_job_load(const PuzzleJob *job, Board *b) {
+    board_load(b, job->work.givens, job->work.solution, job->work.seed, job->holes);
+#if SEARCH_STATS
+    b->stats = job->work.stats;
+#endif
 }
@@ -2,34 +2,210 @@
 #define SUDOKU_H
 
 #include <stdbool.h>
+#include "rng.h"
 
 typedef unsigned char u8;
+typedef unsigned short u16;
+typedef unsigned int u32;
+typedef unsigned long long u64;
 #define CELLS 81
 #define idx(r, c) ((r) * 9 + (c))
+#define box_of(r, c) (((r) / 3) * 3 + (c) / 3)
 
-// Sudoku grids
-extern u8 grid[CELLS];         // Current playable grid
-extern u8 initial_grid[CELLS]; // Original puzzle
-extern u8 solution_grid[CELLS];
+// Candidate masks: bit (v - 1) stands for digit v
+#define ALL_CANDIDATES 0x1FF
+#define digit_bit(v) ((u16)(1u << ((v) - 1)))
+
+typedef struct {
+    u16 rows[9];  // digits already placed in each row
+    u16 cols[9];  // digits already placed in each column
+    u16 boxes[9]; // digits already placed in each 3x3 box
+} CandidateMasks;
 
 // Difficulty holes
-extern int difficultyHoles;
 #define EASY_HOLES   25
 #define MEDIUM_HOLES 40
 #define HARD_HOLES   59
 
-// Game state
-extern int mistakes;
-extern const int maxMistakes;
-extern bool showSolution;
-extern bool gameComplete;
+// Branching heuristic used by count_solutions()
+typedef enum {
+    BRANCH_FIRST_EMPTY, // first empty cell in row-major order
+    BRANCH_MRV,         // empty cell with the fewest legal candidates
+    BRANCH_MRV_LCV      // MRV cell, least-constraining values tried first
+} BranchHeuristic;
+
+// How the generators produce the full solution grid a puzzle is dug from
+typedef enum {
+    FILL_SEARCH,    // randomized backtracking from an empty grid
+    FILL_DIAGONAL,  // boxes 1, 5, 9 as random permutations, then backtracking
+    FILL_TRANSFORM  // random symmetry of a fixed base grid, constant time
+} FillMethod;
+
+typedef struct {
+    BranchHeuristic branch;
+    FillMethod fill;
+    bool propagate;        // place naked and hidden singles before every branch
+    bool iterative;        // explicit-stack searches (default in WASM builds)
+    bool dig_by_exclusion; // hole digging uses has_other_solution() instead of a full count
+} SearchConfig;
+
+// Search statistics, only in builds with -DSEARCH_STATS=1. Without it the
+// counting hooks compile away, the type is left incomplete and Board has
+// no stats member, so disabled builds carry none of it.
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 0
+#endif
+
+#if SEARCH_STATS
+typedef struct SearchStats {
+    long nodes;                 // search nodes visited, fills included
+    long backtracks;            // dead ends: a contradiction or a cell with no legal digit
+    int max_depth;              // most branching cells on one counting-search path
+    long depth_nodes[CELLS];    // counting-search nodes that branched, by depth
+    long depth_children[CELLS]; // digits they tried; / depth_nodes = branching factor
+    long uniqueness_checks;     // one per cell make_unique_puzzle_fast() tried to empty
+} SearchStats;
+#else
+typedef struct SearchStats SearchStats;
+#endif
+
+// Used by the grid-level functions below and copied by board_init().
+// Set it before starting any threads; the searches only read it.
+extern SearchConfig searchDefaults;
+
+#define MAX_MISTAKES 3
+
+// One game: everything a puzzle and its search need, so several boards can
+// be generated and played independently (and on different threads)
+typedef struct {
+    u8 values[CELLS];   // current playable grid
+    u8 givens[CELLS];   // original puzzle, 0 for cells the player fills
+    u8 solution[CELLS];
+    CandidateMasks masks; // kept in sync with values by board_set()
+    SearchConfig config;
+    Rng rng;            // draws the seed of each new puzzle
+    u64 seed;           // seed the current puzzle was generated from, by
+                        // make_puzzle_seeded() or, for a rated puzzle (rate.h),
+                        // make_puzzle_rated_seeded()
+    int holes;
+    int mistakes;
+    bool show_solution;
+    bool complete;
+#if SEARCH_STATS
+    SearchStats stats;  // of the search that generated the puzzle
+#endif
+} Board;
+
+// Masks of the digits in grid; false if a digit appears twice in a unit
+bool masks_init(CandidateMasks *m, const u8 grid[CELLS]);
+
+static inline void masks_place(CandidateMasks *m, int row, int col, u8 val) {
+    u16 b = digit_bit(val);
+    m->rows[row] |= b;
+    m->cols[col] |= b;
+    m->boxes[box_of(row, col)] |= b;
+}
+
+static inline void masks_remove(CandidateMasks *m, int row, int col, u8 val) {
+    u16 b = (u16)~digit_bit(val);
+    m->rows[row] &= b;
+    m->cols[col] &= b;
+    m->boxes[box_of(row, col)] &= b;
+}
+
+// Legal digits for (row, col): one OR of the three units, inverted
+static inline u16 masks_candidates(const CandidateMasks *m, int row, int col) {
+    return (u16)(~(m->rows[row] | m->cols[col] | m->boxes[box_of(row, col)]) & ALL_CANDIDATES);
+}
+
+// Cell k of unit u: rows 0-8, columns 9-17, boxes 18-26, each in
+// row-major order
+static inline int unit_cell(int u, int k) {
+    if (u < 9) return idx(u, k);
+    if (u < 18) return idx(k, u - 9);
+    int b = u - 18;
+    return idx((b / 3) * 3 + k / 3, (b % 3) * 3 + k % 3);
+}
+
+static inline int candidate_count(u16 cands) {
+    return __builtin_popcount(cands);
+}
 
 bool is_valid(const u8 grid[CELLS], int row, int col, u8 val);
 bool find_empty(const u8 grid[CELLS], int *row, int *col);
-void shuffle_u8(u8 *arr, int n);
-bool generator_recursive(u8 grid[CELLS]);
+bool find_empty_mrv(const u8 grid[CELLS], const CandidateMasks *m, int *row, int *col);
+void shuffle_u8(Rng *rng, u8 *arr, int n);
+// Fill an empty grid the way searchDefaults.fill says: FILL_DIAGONAL
+// (default), FILL_SEARCH, or FILL_TRANSFORM through generator_transform()
+bool generator_recursive(u8 grid[CELLS], Rng *rng);
+// Solutions of grid, counting stops at 2 (more than one = not unique)
 int count_solutions(u8 grid[CELLS]);
-void make_puzzle(u8 current_grid[CELLS], u8 fixed_grid[CELLS], int holes);
-bool is_complete(void);
+
+// Receives each solution in place; the grid is only valid during the call.
+// Return false to stop the enumeration.
+typedef bool (*SolutionCallback)(const u8 grid[CELLS], void *user);
+
+// Enumerate solutions of grid, stopping after limit (<= 0: no limit).
+// on_solution may be NULL. Returns the number of solutions found and, if
+// nodes is not NULL, the number of search nodes visited. grid is left as given.
+int enumerate_solutions(u8 grid[CELLS], int limit, SolutionCallback on_solution, void *user, long *nodes);
+// Same results as generator_recursive()/count_solutions(), driven by a
+// fixed 81-entry explicit stack instead of recursion
+bool generator_iterative(u8 grid[CELLS], Rng *rng);
+// out = base under a random validity-preserving symmetry: digit relabeling,
+// row permutations within bands, band permutations, the same for columns
+// and stacks, and transposition. Empty cells stay empty, so it applies to
+// puzzles as well as solutions. out and base may not overlap.
+void grid_transform(u8 out[CELLS], const u8 base[CELLS], Rng *rng);
+// grid_transform() of a built-in solution grid. Only reaches grids
+// equivalent to that base (up to 2*6^8*9! of them), so it is fast rather
+// than uniform over all grids.
+bool generator_transform(u8 grid[CELLS], Rng *rng);
+int count_solutions_iterative(u8 grid[CELLS]);
+#if SEARCH_STATS
+// count_solutions() adding its statistics to *stats
+int count_solutions_stats(u8 grid[CELLS], SearchStats *stats);
+#endif
+// Fill every cell forced by naked/hidden singles; returns the number of
+// cells placed, or -1 (grid left unchanged) if the puzzle is contradictory
+int solve_singles(u8 grid[CELLS]);
+// True if grid has a solution with cell pos holding something other than
+// known. With pos just emptied from a unique puzzle whose solution had
+// known there, false means the puzzle is still unique.
+bool has_other_solution(u8 grid[CELLS], int pos, u8 known);
+// The per-Board forms of the two steps of puzzle generation, for
+// generators outside this file: the solution grid filled from rng, and the
+// test that pos, just emptied from a unique puzzle with known there, leaves
+// it unique. Both follow config (fill, iterative, branch, propagate and
+// dig_by_exclusion) exactly as make_unique_puzzle_fast() does.
+void generator_with(u8 grid[CELLS], Rng *rng, const SearchConfig *config);
+bool dig_keeps_unique(u8 grid[CELLS], int pos, u8 known, const SearchConfig *config);
+
+// Empty board using searchDefaults, MEDIUM_HOLES difficulty, rng seeded with 1
+void board_init(Board *b);
+void board_seed(Board *b, u64 seed);
+void board_set(Board *b, int cell, u8 val);
+// Puzzle generated from b->seed alone: the same seed, holes and config give
+// the same puzzle on every platform
+void make_unique_puzzle_fast(Board *b, int holes);
+// New puzzle with holes empty cells from seed; resets mistakes and the game flags
+void make_puzzle_seeded(Board *b, u64 seed, int holes);
+// make_puzzle_seeded() with the next seed drawn from b->rng
+void make_puzzle(Board *b, int holes);
+// Start a game on a puzzle generated elsewhere, as make_puzzle_seeded() would
+void board_load(Board *b, const u8 givens[CELLS], const u8 solution[CELLS], u64 seed, int holes);
+bool is_complete(const Board *b);
+
+// make_puzzle_seeded() as a resumable job for single-threaded targets: each
+// puzzle_job_step() runs for about budget_us and the last one finishes the
+// puzzle. The board being played is untouched until puzzle_job_load().
+typedef struct PuzzleJob PuzzleJob;
+PuzzleJob *puzzle_job_create(const SearchConfig *config); // NULL on failure
+void puzzle_job_destroy(PuzzleJob *job);
+void puzzle_job_start(PuzzleJob *job, u64 seed, int holes);
+// True once the puzzle is ready. Stops within a few search nodes of the budget.
+bool puzzle_job_step(PuzzleJob *job, long budget_us);
+float puzzle_job_progress(const PuzzleJob *job); // 0..1
+void puzzle_job_load(const PuzzleJob *job, Board *b);
 
 #endif // SUDOKU_H
@@ -0,0 +1,20 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+// Clock and sample sorting shared by the native tools (bench, solve).
+// Define _POSIX_C_SOURCE 199309L or later before the first include.
+#include <time.h>
+
+static inline double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// qsort() comparator for ascending doubles
+static inline int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+#endif // TIMING_H